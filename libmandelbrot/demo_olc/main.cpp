@@ -79,14 +79,12 @@ public:
         if (GetKey(olc::Key::A).bPressed)
         {
             threshold += 128;
-            scene->Recompute();
         }
         if (GetKey(olc::Key::S).bPressed)
         {
             if (threshold > 128)
             {
                 threshold -= 128;
-                scene->Recompute();
             }
         }
 
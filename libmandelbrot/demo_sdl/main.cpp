@@ -218,7 +218,6 @@ int main(int argc, char* argv[])
                         keyIterationUpPressed = true;
                         threshold += 128;
                         MDB_INFO("up to {}", threshold);
-                        scene.Recompute();
                     }
                     break;
 
@@ -230,7 +229,6 @@ int main(int argc, char* argv[])
                         {
                             threshold -= 128;
                             MDB_INFO("down to {}", threshold);
-                            scene.Recompute();
                         }
                     }
                     break;
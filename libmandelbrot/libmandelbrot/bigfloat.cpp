@@ -0,0 +1,290 @@
+#include <cmath>
+#include <limits>
+#include "bigfloat.h"
+
+namespace mdb {
+
+constexpr int LIMB_BITS = 32;
+constexpr int MANTISSA_BITS = BigFloat::LIMBS * LIMB_BITS;
+
+// Bits shifted out are dropped
+template<size_t N>
+static std::array<uint32_t, N> ShiftRight(const std::array<uint32_t, N>& limbs, int bits) noexcept
+{
+    std::array<uint32_t, N> result{};
+    if (bits >= static_cast<int>(N) * LIMB_BITS)
+    {
+        return result;
+    }
+
+    const int limbShift = bits / LIMB_BITS;
+    const int bitShift = bits % LIMB_BITS;
+
+    for (int i = static_cast<int>(N) - 1; i >= limbShift; --i)
+    {
+        result[i] = limbs[i - limbShift] >> bitShift;
+        if (bitShift > 0 && i - limbShift - 1 >= 0)
+        {
+            result[i] |= limbs[i - limbShift - 1] << (LIMB_BITS - bitShift);
+        }
+    }
+    return result;
+}
+
+template<size_t N>
+static std::array<uint32_t, N> ShiftLeft(const std::array<uint32_t, N>& limbs, int bits) noexcept
+{
+    std::array<uint32_t, N> result{};
+    if (bits >= static_cast<int>(N) * LIMB_BITS)
+    {
+        return result;
+    }
+
+    const int limbShift = bits / LIMB_BITS;
+    const int bitShift = bits % LIMB_BITS;
+
+    for (int i = 0; i + limbShift < static_cast<int>(N); ++i)
+    {
+        result[i] = limbs[i + limbShift] << bitShift;
+        if (bitShift > 0 && i + limbShift + 1 < static_cast<int>(N))
+        {
+            result[i] |= limbs[i + limbShift + 1] >> (LIMB_BITS - bitShift);
+        }
+    }
+    return result;
+}
+
+// Leading zero bits, N * LIMB_BITS if all are zero
+template<size_t N>
+static int LeadingZeros(const std::array<uint32_t, N>& limbs) noexcept
+{
+    int zeros = 0;
+    for (uint32_t limb : limbs)
+    {
+        if (limb != 0)
+        {
+            for (uint32_t bit = 0x80000000u; (limb & bit) == 0; bit >>= 1)
+            {
+                ++zeros;
+            }
+            return zeros;
+        }
+        zeros += LIMB_BITS;
+    }
+    return zeros;
+}
+
+BigFloat::BigFloat(double value) noexcept
+{
+    if (value == 0)
+    {
+        return;
+    }
+
+    negative = value < 0;
+
+    // 53 significant bits at most, so the top two limbs hold them all
+    const double fraction = std::frexp(std::fabs(value), &exponent);
+    const uint64_t bits = static_cast<uint64_t>(std::ldexp(fraction, 64));
+    mantissa[0] = static_cast<uint32_t>(bits >> 32);
+    mantissa[1] = static_cast<uint32_t>(bits);
+}
+
+BigFloat BigFloat::FromInteger(int64_t value) noexcept
+{
+    BigFloat result;
+    if (value == 0)
+    {
+        return result;
+    }
+
+    result.negative = value < 0;
+
+    // Unsigned, so the most negative value has a magnitude too
+    uint64_t bits = result.negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    result.exponent = 64;
+    while ((bits >> 63) == 0)
+    {
+        bits <<= 1;
+        --result.exponent;
+    }
+
+    result.mantissa[0] = static_cast<uint32_t>(bits >> 32);
+    result.mantissa[1] = static_cast<uint32_t>(bits);
+    return result;
+}
+
+// Converting the top 64 bits to double would round twice, and miss a tie broken further down
+double BigFloat::ToDouble() const noexcept
+{
+    constexpr int DROPPED = 64 - std::numeric_limits<double>::digits;
+    constexpr uint64_t HALF = uint64_t(1) << (DROPPED - 1);
+
+    const uint64_t bits = (static_cast<uint64_t>(mantissa[0]) << 32) | mantissa[1];
+    uint64_t kept = bits >> DROPPED;
+    const uint64_t rest = bits & ((uint64_t(1) << DROPPED) - 1);
+
+    bool sticky = false;
+    for (int i = 2; i < LIMBS; ++i)
+    {
+        sticky = sticky || mantissa[i] != 0;
+    }
+
+    if (rest > HALF || (rest == HALF && (sticky || (kept & 1) != 0)))
+    {
+        ++kept;     // Up to 2^53 at most, still exact
+    }
+
+    const double magnitude = std::ldexp(static_cast<double>(kept), exponent - std::numeric_limits<double>::digits);
+    return negative ? -magnitude : magnitude;
+}
+
+int BigFloat::CompareMagnitudes(const BigFloat& a, const BigFloat& b) noexcept
+{
+    if (a.exponent != b.exponent)
+    {
+        return (a.exponent > b.exponent) ? 1 : -1;
+    }
+
+    for (int i = 0; i < LIMBS; ++i)
+    {
+        if (a.mantissa[i] != b.mantissa[i])
+        {
+            return (a.mantissa[i] > b.mantissa[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+BigFloat BigFloat::AddMagnitudes(const BigFloat& a, const BigFloat& b) noexcept
+{
+    const Mantissa_t aligned = ShiftRight(b.mantissa, a.exponent - b.exponent);
+
+    BigFloat result;
+    result.exponent = a.exponent;
+
+    uint64_t carry = 0;
+    for (int i = LIMBS - 1; i >= 0; --i)
+    {
+        const uint64_t sum = static_cast<uint64_t>(a.mantissa[i]) + aligned[i] + carry;
+        result.mantissa[i] = static_cast<uint32_t>(sum);
+        carry = sum >> LIMB_BITS;
+    }
+
+    if (carry != 0)
+    {
+        result.mantissa = ShiftRight(result.mantissa, 1);
+        result.mantissa[0] |= 0x80000000u;
+        ++result.exponent;
+    }
+    return result;
+}
+
+BigFloat BigFloat::SubtractMagnitudes(const BigFloat& a, const BigFloat& b) noexcept
+{
+    const Mantissa_t aligned = ShiftRight(b.mantissa, a.exponent - b.exponent);
+
+    BigFloat result;
+
+    int64_t borrow = 0;
+    for (int i = LIMBS - 1; i >= 0; --i)
+    {
+        int64_t difference = static_cast<int64_t>(a.mantissa[i]) - aligned[i] - borrow;
+        borrow = (difference < 0) ? 1 : 0;
+        result.mantissa[i] = static_cast<uint32_t>(difference + (borrow << LIMB_BITS));
+    }
+
+    // Cancellation leaves leading zeros
+    const int zeros = LeadingZeros(result.mantissa);
+    if (zeros == MANTISSA_BITS)
+    {
+        return BigFloat();
+    }
+
+    result.mantissa = ShiftLeft(result.mantissa, zeros);
+    result.exponent = a.exponent - zeros;
+    return result;
+}
+
+BigFloat operator+(const BigFloat& a, const BigFloat& b) noexcept
+{
+    if (a.IsZero())
+    {
+        return b;
+    }
+    if (b.IsZero())
+    {
+        return a;
+    }
+
+    BigFloat result;
+    if (a.negative == b.negative)
+    {
+        result = (a.exponent >= b.exponent) ? BigFloat::AddMagnitudes(a, b) : BigFloat::AddMagnitudes(b, a);
+        result.negative = a.negative;
+        return result;
+    }
+
+    const int comparison = BigFloat::CompareMagnitudes(a, b);
+    if (comparison == 0)
+    {
+        return BigFloat();
+    }
+
+    if (comparison > 0)
+    {
+        result = BigFloat::SubtractMagnitudes(a, b);
+        result.negative = a.negative;
+    }
+    else
+    {
+        result = BigFloat::SubtractMagnitudes(b, a);
+        result.negative = b.negative;
+    }
+    return result;
+}
+
+BigFloat operator-(const BigFloat& a, const BigFloat& b) noexcept
+{
+    return a + (-b);
+}
+
+BigFloat operator*(const BigFloat& a, const BigFloat& b) noexcept
+{
+    if (a.IsZero() || b.IsZero())
+    {
+        return BigFloat();
+    }
+
+    // Schoolbook, most significant limb first
+    std::array<uint32_t, 2 * BigFloat::LIMBS> product{};
+    for (int i = BigFloat::LIMBS - 1; i >= 0; --i)
+    {
+        uint64_t carry = 0;
+        for (int j = BigFloat::LIMBS - 1; j >= 0; --j)
+        {
+            const uint64_t term = static_cast<uint64_t>(a.mantissa[i]) * b.mantissa[j] + product[i + j + 1] + carry;
+            product[i + j + 1] = static_cast<uint32_t>(term);
+            carry = term >> LIMB_BITS;
+        }
+        product[i] = static_cast<uint32_t>(carry);
+    }
+
+    // Both factors are in [0.5, 1), so the product is in [0.25, 1)
+    BigFloat result;
+    result.exponent = a.exponent + b.exponent;
+    if ((product[0] & 0x80000000u) == 0)
+    {
+        product = ShiftLeft(product, 1);
+        --result.exponent;
+    }
+
+    for (int i = 0; i < BigFloat::LIMBS; ++i)
+    {
+        result.mantissa[i] = product[i];
+    }
+    result.negative = a.negative != b.negative;
+    return result;
+}
+
+} // namespace mdb
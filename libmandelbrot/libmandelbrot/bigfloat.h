@@ -0,0 +1,64 @@
+#ifndef BIGFLOAT_H
+#define BIGFLOAT_H
+
+#include <array>
+#include <cstdint>
+
+namespace mdb {
+
+// Binary floating point with a fixed, wide mantissa, for coordinates past double precision
+// Arithmetic truncates below the last limb; that error is far smaller than any texel it is used for
+class BigFloat
+{
+public:
+
+    constexpr static int LIMBS = 10;    // 320 bits, enough for texel lengths down to about 1e-80
+
+    BigFloat() noexcept = default;      // Zero
+
+    // Exact, for finite values
+    BigFloat(double value) noexcept;
+
+    // Exact for any value, where doubles stop at 2^53
+    [[nodiscard]] static BigFloat FromInteger(int64_t value) noexcept;
+
+    // Nearest double, ties to even, rounded once from the whole mantissa; below the normal range, ldexp rounds again
+    [[nodiscard]] double ToDouble() const noexcept;
+
+    [[nodiscard]] bool IsZero() const noexcept { return mantissa[0] == 0; }
+    [[nodiscard]] bool IsNegative() const noexcept { return negative; }
+
+    BigFloat operator-() const noexcept
+    {
+        BigFloat result = *this;
+        result.negative = !negative && !IsZero();
+        return result;
+    }
+
+    friend BigFloat operator+(const BigFloat& a, const BigFloat& b) noexcept;
+    friend BigFloat operator-(const BigFloat& a, const BigFloat& b) noexcept;
+    friend BigFloat operator*(const BigFloat& a, const BigFloat& b) noexcept;
+
+    BigFloat& operator+=(const BigFloat& other) noexcept { return *this = *this + other; }
+    BigFloat& operator-=(const BigFloat& other) noexcept { return *this = *this - other; }
+    BigFloat& operator*=(const BigFloat& other) noexcept { return *this = *this * other; }
+
+private:
+
+    typedef std::array<uint32_t, LIMBS> Mantissa_t;
+
+    // |a| >= |b|, signs ignored
+    static BigFloat AddMagnitudes(const BigFloat& a, const BigFloat& b) noexcept;
+    static BigFloat SubtractMagnitudes(const BigFloat& a, const BigFloat& b) noexcept;
+    static int CompareMagnitudes(const BigFloat& a, const BigFloat& b) noexcept;
+
+    // Value is 0.mantissa * 2^exponent, most significant limb first
+    // The top bit of mantissa[0] is set, unless the value is zero
+    Mantissa_t mantissa{};
+    int exponent = 0;
+    bool negative = false;
+};
+
+} // namespace mdb
+
+#endif // !BIGFLOAT_H
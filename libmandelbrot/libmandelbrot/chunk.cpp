@@ -1,44 +1,710 @@
-#include <complex>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
 #include "chunk.h"
+#include "reference_orbit.h"
 
 namespace mdb {
 
-typedef std::complex<Number_t> Complex_t;//TODO: not necessary?
+// Iterates texels, u + v * pitch, as one list, so lanes drain once
+static KernelStats IterateList(const KernelArgs& args, const std::vector<int>& texels)
+{
+    if (texels.empty())
+    {
+        return KernelStats();
+    }
+
+    KernelArgs list = args;
+    list.texels = &texels;
+    return RunKernel(list);
+}
+
+// Iterates rect, a part of the rectangle of args, but for texels set in known, which go to the kernel as a list
+static KernelStats Iterate(const KernelArgs& args, RectI rect, const std::vector<bool>* known = nullptr)
+{
+    if (rect.w <= 0 || rect.h <= 0)
+    {
+        return KernelStats();
+    }
+
+    if (known == nullptr)
+    {
+        KernelArgs part = args;
+        part.beginU = rect.x;
+        part.beginV = rect.y;
+        part.width = rect.w;
+        part.height = rect.h;
+        return RunKernel(part);
+    }
+
+    KernelStats stats;
+    std::vector<int> texels;
+    texels.reserve(rect.w * rect.h);
+    for (int v = rect.y; v < rect.y + rect.h; ++v)
+    {
+        for (int u = rect.x; u < rect.x + rect.w; ++u)
+        {
+            if ((*known)[u + v * args.pitch])
+            {
+                ++stats.reusedTexels;
+            }
+            else
+            {
+                texels.push_back(u + v * args.pitch);
+            }
+        }
+    }
+
+    stats += IterateList(args, texels);
+    return stats;
+}
+
+// Whether every texel on the border of rect has the same value, given in value
+static bool UniformBorder(const KernelArgs& args, RectI rect, Iteration_t& value)
+{
+    const Iteration_t* iterations = args.iterations;
+    const int top = rect.y * args.pitch;
+    const int bottom = (rect.y + rect.h - 1) * args.pitch;
+
+    value = iterations[rect.x + top];
+
+    for (int u = rect.x; u < rect.x + rect.w; ++u)
+    {
+        if (iterations[u + top] != value || iterations[u + bottom] != value)
+        {
+            return false;
+        }
+    }
+
+    for (int v = rect.y + 1; v < rect.y + rect.h - 1; ++v)
+    {
+        const int row = v * args.pitch;
+        if (iterations[rect.x + row] != value || iterations[rect.x + rect.w - 1 + row] != value)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Border of rect already computed
+// The set is connected, so a uniform border means a uniform inside
+static void Subdivide(const KernelArgs& args, RectI rect, const std::vector<bool>* known, KernelStats& stats)
+{
+    const RectI inner = { rect.x + 1, rect.y + 1, rect.w - 2, rect.h - 2 };
+    if (inner.w <= 0 || inner.h <= 0)
+    {
+        return;
+    }
+
+    Iteration_t value;
+    if (UniformBorder(args, rect, value))
+    {
+        for (int v = inner.y; v < inner.y + inner.h; ++v)
+        {
+            Iteration_t* row = args.iterations + v * args.pitch;
+            std::fill(row + inner.x, row + inner.x + inner.w, value);
+        }
+
+        stats.filledTexels += inner.w * inner.h;
+        return;
+    }
+
+    if (rect.w <= Chunk::SUBDIVIDE_MIN || rect.h <= Chunk::SUBDIVIDE_MIN)
+    {
+        stats += Iterate(args, inner, known);
+        return;
+    }
+
+    // Halved across the longer side, the line in between belonging to both halves
+    if (rect.w >= rect.h)
+    {
+        const int split = rect.x + rect.w / 2;
+        stats += Iterate(args, { split, inner.y, 1, inner.h }, known);
+
+        Subdivide(args, { rect.x, rect.y, split - rect.x + 1, rect.h }, known, stats);
+        Subdivide(args, { split, rect.y, rect.x + rect.w - split, rect.h }, known, stats);
+    }
+    else
+    {
+        const int split = rect.y + rect.h / 2;
+        stats += Iterate(args, { inner.x, split, inner.w, 1 }, known);
+
+        Subdivide(args, { rect.x, rect.y, rect.w, split - rect.y + 1 }, known, stats);
+        Subdivide(args, { rect.x, split, rect.w, rect.y + rect.h - split }, known, stats);
+    }
+}
+
+// Border of the whole rectangle first
+static KernelStats ComputeSubdivided(const KernelArgs& args, const std::vector<bool>* known)
+{
+    const RectI rect = { args.beginU, args.beginV, args.width, args.height };
+
+    KernelStats stats;
+    stats += Iterate(args, { rect.x, rect.y, rect.w, 1 }, known);
+    stats += Iterate(args, { rect.x, rect.y + rect.h - 1, rect.w, 1 }, known);
+    stats += Iterate(args, { rect.x, rect.y + 1, 1, rect.h - 2 }, known);
+    stats += Iterate(args, { rect.x + rect.w - 1, rect.y + 1, 1, rect.h - 2 }, known);
+
+    Subdivide(args, rect, known, stats);
+    return stats;
+}
+
+// Starts from the border of the rectangle: a texel with a neighbour of another value is on the edge of a band,
+// so its neighbours are computed in turn, and so on along the edge
+// Edges are followed a wave at a time, the texels each wave needs going to the kernel as one list
+// Areas no edge reached are enclosed by loaded texels: filled if those all have the same value, computed otherwise
+static KernelStats ComputeTraced(const KernelArgs& args, const std::vector<bool>* known)
+{
+    constexpr uint8_t LOADED = 0x1;
+    constexpr uint8_t QUEUED = 0x2;
+    constexpr uint8_t ENCLOSED = 0x4;
+
+    const int width = args.width;
+    const int height = args.height;
+    const int texelCount = width * height;
+
+    KernelStats stats;
+    std::vector<uint8_t> state(texelCount, 0);
+    std::vector<int> wave;      // Queued, so edges are looked for around them once their neighbours are loaded
+    std::vector<int> next;
+    std::vector<int> texels;    // u + v * pitch, for the kernel
+
+    auto index = [&](int texel)
+    {
+        return args.beginU + texel % width + (args.beginV + texel / width) * args.pitch;
+    };
+
+    auto at = [&](int texel) -> Iteration_t&
+    {
+        return args.iterations[index(texel)];
+    };
+
+    // Known texels are there from the start
+    if (known != nullptr)
+    {
+        for (int texel = 0; texel < texelCount; ++texel)
+        {
+            if ((*known)[index(texel)])
+            {
+                state[texel] |= LOADED;
+                ++stats.reusedTexels;
+            }
+        }
+    }
+
+    auto load = [&](int texel)
+    {
+        if ((state[texel] & LOADED) == 0)
+        {
+            state[texel] |= LOADED;
+            texels.push_back(index(texel));
+        }
+    };
+
+    auto enqueue = [&](int texel)
+    {
+        if ((state[texel] & QUEUED) == 0)
+        {
+            state[texel] |= QUEUED;
+            next.push_back(texel);
+        }
+    };
+
+    for (int u = 0; u < width; ++u)
+    {
+        enqueue(u);
+        enqueue(u + (height - 1) * width);
+    }
+    for (int v = 1; v < height - 1; ++v)
+    {
+        enqueue(v * width);
+        enqueue(width - 1 + v * width);
+    }
+
+    while (next.empty() == false)
+    {
+        wave.swap(next);
+        next.clear();
+
+        texels.clear();
+        for (int texel : wave)
+        {
+            const int u = texel % width;
+            const int v = texel / width;
+
+            load(texel);
+            if (u > 0)
+            {
+                load(texel - 1);
+            }
+            if (u < width - 1)
+            {
+                load(texel + 1);
+            }
+            if (v > 0)
+            {
+                load(texel - width);
+            }
+            if (v < height - 1)
+            {
+                load(texel + width);
+            }
+        }
+        stats += IterateList(args, texels);
+
+        // Texels left unwritten, the result is thrown away
+        if (Cancelled(args))
+        {
+            return stats;
+        }
+
+        for (int texel : wave)
+        {
+            const int u = texel % width;
+            const int v = texel / width;
+            const Iteration_t center = at(texel);
+
+            const bool hasLeft = (u > 0);
+            const bool hasRight = (u < width - 1);
+            const bool hasUp = (v > 0);
+            const bool hasDown = (v < height - 1);
+
+            const bool left = hasLeft && at(texel - 1) != center;
+            const bool right = hasRight && at(texel + 1) != center;
+            const bool up = hasUp && at(texel - width) != center;
+            const bool down = hasDown && at(texel + width) != center;
+
+            if (left)
+            {
+                enqueue(texel - 1);
+            }
+            if (right)
+            {
+                enqueue(texel + 1);
+            }
+            if (up)
+            {
+                enqueue(texel - width);
+            }
+            if (down)
+            {
+                enqueue(texel + width);
+            }
+
+            // Diagonals too, so edges running at an angle aren't lost
+            if (hasUp && hasLeft && (up || left))
+            {
+                enqueue(texel - width - 1);
+            }
+            if (hasUp && hasRight && (up || right))
+            {
+                enqueue(texel - width + 1);
+            }
+            if (hasDown && hasLeft && (down || left))
+            {
+                enqueue(texel + width - 1);
+            }
+            if (hasDown && hasRight && (down || right))
+            {
+                enqueue(texel + width + 1);
+            }
+        }
+    }
+
+    // Areas of texels not loaded, 4-connected; the border is all loaded, so each is enclosed
+    std::vector<int> area;
+    texels.clear();
+    for (int first = 0; first < texelCount; ++first)
+    {
+        if (state[first] != 0)
+        {
+            continue;
+        }
+
+        bool uniform = true;
+        bool bounded = false;
+        Iteration_t value = 0;
+
+        auto visit = [&](int texel)
+        {
+            if (state[texel] & LOADED)
+            {
+                uniform = uniform && (bounded == false || at(texel) == value);
+                value = at(texel);
+                bounded = true;
+            }
+            else if ((state[texel] & ENCLOSED) == 0)
+            {
+                state[texel] |= ENCLOSED;
+                area.push_back(texel);
+            }
+        };
+
+        area.clear();
+        visit(first);
+        for (size_t i = 0; i < area.size(); ++i)
+        {
+            const int texel = area[i];
+            const int u = texel % width;
+            const int v = texel / width;
+
+            if (u > 0)
+            {
+                visit(texel - 1);
+            }
+            if (u < width - 1)
+            {
+                visit(texel + 1);
+            }
+            if (v > 0)
+            {
+                visit(texel - width);
+            }
+            if (v < height - 1)
+            {
+                visit(texel + width);
+            }
+        }
+
+        if (uniform)
+        {
+            for (int texel : area)
+            {
+                at(texel) = value;
+            }
+            stats.filledTexels += static_cast<uint32_t>(area.size());
+        }
+        else
+        {
+            for (int texel : area)
+            {
+                texels.push_back(index(texel));
+            }
+        }
+    }
+    stats += IterateList(args, texels);
 
-constexpr Number_t absSquared(const Complex_t& c) noexcept
+    return stats;
+}
+
+void Chunk::SplitCoordinate(Coordinate_t value, Number_t& head, Number_t (&tail)[3])
+{
+    head = value.ToDouble();
+    value -= head;
+    for (Number_t& term : tail)
+    {
+        term = value.ToDouble();
+        value -= term;
+    }
+}
+
+const char* Chunk::StrategyName(Strategy strategy) noexcept
+{
+    switch (strategy)
+    {
+    case Strategy::BRUTE_FORCE: return "brute force";
+    case Strategy::SUBDIVIDE: return "subdivide";
+    case Strategy::SUBDIVIDE_GUARDED: return "subdivide guarded";
+    case Strategy::BOUNDARY_TRACE: return "boundary trace";
+    }
+    return "unknown";
+}
+
+KernelArgs Chunk::TileArgs(const Coordinate_t& originX, const Coordinate_t& originY, Number_t texelLength, Iteration_t threshold,
+    Precision precision, const ReferenceOrbit* reference, int tile) noexcept
 {
-    return (c.real() * c.real() + c.imag() * c.imag());
+    KernelArgs args;
+    args.texelLength = texelLength;
+    args.threshold = threshold;
+    args.precision = precision;
+    args.reference = reference;
+
+    if (precision == Precision::PERTURBATION)
+    {
+        args.originX = (originX - reference->X()).ToDouble();
+        args.originY = (originY - reference->Y()).ToDouble();
+    }
+    else
+    {
+        SplitCoordinate(originX, args.originX, args.originTailX);
+        SplitCoordinate(originY, args.originY, args.originTailY);
+    }
+
+    args.beginU = (tile % TILES_PER_SIDE) * TILE_SIZE;
+    args.beginV = (tile / TILES_PER_SIDE) * TILE_SIZE;
+    args.width = TILE_SIZE;
+    args.height = TILE_SIZE;
+    args.iterations = iterations.data();
+    args.pitch = SIZE;
+    args.cancelled = cancelled;
+    return args;
 }
 
-void Chunk::Compute(Number_t originX, Number_t originY, Number_t texelLength, Iteration_t threshold)
+void Chunk::Compute(const Coordinate_t& originX, const Coordinate_t& originY, Number_t texelLength, Iteration_t threshold, Precision precision,
+    Strategy strategy, const ReferenceOrbit* reference, int tile, const std::vector<bool>* known)
 {
-    int index = 0;
+    KernelArgs args = TileArgs(originX, originY, texelLength, threshold, precision, reference, tile);
+    tileStats[tile] = KernelStats();
 
-    for (int texelV = 0; texelV < SIZE; ++texelV)
+    // Tiles still queued when cancelled cost nothing
+    if (Cancelled(args))
     {
-        for (int texelU = 0; texelU < SIZE; ++texelU, ++index)
+        return;
+    }
+
+    // Orbits of the previous computation are no use here
+    OrbitStore& store = orbits[tile];
+    store.Reset(KeepsInside(precision) ? orbitMemory / TILE_COUNT : 0, threshold);
+    if (store.memory > 0)
+    {
+        args.orbits = &store;
+    }
+
+    if (known != nullptr)
+    {
+        int knownCount = 0;
+        for (int v = args.beginV; v < args.beginV + args.height; ++v)
         {
-            Complex_t c = { 0.0, 0.0 };
-            Complex_t dc =
+            for (int u = args.beginU; u < args.beginU + args.width; ++u)
             {
-                originX + texelU * texelLength,
-                originY - texelV * texelLength
-            };
+                knownCount += (*known)[u + v * SIZE] ? 1 : 0;
+            }
+        }
 
-            Iteration_t it = 0;
-            for (; it < threshold; ++it)
+        // All there already, nothing to subdivide or trace
+        if (knownCount == TILE_SIZE * TILE_SIZE)
+        {
+            tileStats[tile].reusedTexels = knownCount;
+            return;
+        }
+        if (knownCount == 0)
+        {
+            known = nullptr;
+        }
+    }
+
+    switch (strategy)
+    {
+    case Strategy::BRUTE_FORCE:
+        tileStats[tile] = Iterate(args, { args.beginU, args.beginV, args.width, args.height }, known);
+        break;
+
+    case Strategy::SUBDIVIDE:
+        tileStats[tile] = ComputeSubdivided(args, known);
+        break;
+
+    case Strategy::BOUNDARY_TRACE:
+        tileStats[tile] = ComputeTraced(args, known);
+        break;
+
+    case Strategy::SUBDIVIDE_GUARDED:
+    {
+        KernelStats stats = ComputeSubdivided(args, known);
+
+        std::array<Iteration_t, TILE_SIZE * TILE_SIZE> subdivided;
+        for (int v = 0; v < TILE_SIZE; ++v)
+        {
+            const Iteration_t* row = iterations.data() + args.beginU + (args.beginV + v) * SIZE;
+            std::copy(row, row + TILE_SIZE, subdivided.begin() + v * TILE_SIZE);
+        }
+
+        // Iterated values are kept, orbits were already
+        KernelArgs check = args;
+        check.orbits = nullptr;
+        RunKernel(check);
+
+        for (int v = 0; v < TILE_SIZE; ++v)
+        {
+            const Iteration_t* row = iterations.data() + args.beginU + (args.beginV + v) * SIZE;
+            for (int u = 0; u < TILE_SIZE; ++u)
             {
-                c = c * c + dc;
+                if (row[u] != subdivided[u + v * TILE_SIZE])
+                {
+                    ++stats.guardMismatches;
+                }
+            }
+        }
 
-                if (absSquared(c) > static_cast<Number_t>(2 * 2))
+        // Cancelled halfway, either may have stopped anywhere
+        if (stats.guardMismatches > 0 && Cancelled(args) == false)
+        {
+            MDB_WARN("Subdivision got {} texels of tile {} wrong", stats.guardMismatches, tile);
+        }
+
+        tileStats[tile] = stats;
+        break;
+    }
+    }
+}
+
+// Orbits kept at from are carried on first, then runs of the other stuck texels along each row start over
+// Short gaps are iterated along, so the wide kernels still get several texels at a time:
+// texels that escaped before from escape at the same iteration again
+// Not subdivided: a uniform border at from says nothing of the inside at threshold
+void Chunk::Raise(const Coordinate_t& originX, const Coordinate_t& originY, Number_t texelLength, Iteration_t from, Iteration_t threshold,
+    Precision precision, const ReferenceOrbit* reference, int tile)
+{
+    KernelArgs args = TileArgs(originX, originY, texelLength, threshold, precision, reference, tile);
+    const int endU = args.beginU + args.width;
+    tileStats[tile] = KernelStats();
+
+    if (Cancelled(args))
+    {
+        return;
+    }
+
+    // Empty unless kept at from, in this precision
+    OrbitStore kept;
+    std::swap(kept, orbits[tile]);
+    if (kept.reached != from || KeepsInside(precision) == false)
+    {
+        kept.Reset(0, from);
+    }
+
+    OrbitStore& store = orbits[tile];
+    store.Reset(KeepsInside(precision) ? orbitMemory / TILE_COUNT : 0, threshold);
+    if (store.memory > 0)
+    {
+        args.orbits = &store;
+    }
+
+    // Texels of the tile the kept store accounts for
+    std::array<bool, TILE_SIZE * TILE_SIZE> known = {};
+    auto local = [&](int texel)
+    {
+        return (texel % SIZE - args.beginU) + (texel / SIZE - args.beginV) * TILE_SIZE;
+    };
+    for (int texel : kept.texel)
+    {
+        known[local(texel)] = true;
+    }
+    for (int texel : kept.inside)
+    {
+        known[local(texel)] = true;
+    }
+
+    KernelStats stats;
+    for (int v = args.beginV; v < args.beginV + args.height && Cancelled(args) == false; ++v)
+    {
+        const Iteration_t* row = iterations.data() + v * SIZE;
+        auto fresh = [&](int u)
+        {
+            return row[u] == from && known[local(u + v * SIZE)] == false;
+        };
+
+        int u = args.beginU;
+        while (u < endU)
+        {
+            if (fresh(u) == false)
+            {
+                ++u;
+                continue;
+            }
+
+            // On to the last fresh texel before a gap of RAISE_GAP others, or a known one
+            const int begin = u;
+            int end = u + 1;
+            for (++u; u < endU && u - end < RAISE_GAP && (row[u] != from || fresh(u)); ++u)
+            {
+                if (fresh(u))
                 {
-                    break;
+                    end = u + 1;
                 }
             }
+            u = end;
+            stats += Iterate(args, { begin, v, end - begin, 1 });
+        }
+    }
 
-            iterations[index] = it;
+    for (int texel : kept.inside)
+    {
+        iterations[texel] = threshold;
+        if (args.orbits != nullptr)
+        {
+            args.orbits->AddInside(texel);
         }
     }
+
+    if (kept.Size() > 0)
+    {
+        args.resume = &kept;
+        stats += RunKernel(args);
+    }
+
+    tileStats[tile] = stats;
+}
+
+void Chunk::Load(const Iterations_t& iterations, Iteration_t threshold, Precision precision) noexcept
+{
+    this->iterations = iterations;
+    this->threshold = threshold;
+    this->precision = precision;
+    tileStats = {};
+    DropOrbits();
+}
+
+void Chunk::DropOrbits() noexcept
+{
+    for (OrbitStore& store : orbits)
+    {
+        if (store.memory > 0)
+        {
+            store.Reset(0, 0);
+        }
+    }
+}
+
+KernelStats Chunk::Stats() const noexcept
+{
+    KernelStats stats;
+    for (const KernelStats& tile : tileStats)
+    {
+        stats += tile;
+    }
+    return stats;
+}
+
+Precision Chunk::SelectPrecision(Number_t magnitude, Number_t texelLength, bool allowFloat, Precision deep) noexcept
+{
+    // Fixed point only holds orbits starting within radius 2, the others escape right away anyway
+    const bool fixedFits = (magnitude <= 2);
+    const Number_t fixedSpacing = std::ldexp(static_cast<Number_t>(1), -FIXED_FRACTION_BITS);
+
+    // Escaping orbits reach 2 anyway
+    magnitude = std::fmax(magnitude, static_cast<Number_t>(2));
+
+    // Spacing around magnitude is magnitude * epsilon at most
+    const Number_t floatSpacing = magnitude * std::numeric_limits<float>::epsilon();
+    const Number_t doubleSpacing = magnitude * std::numeric_limits<double>::epsilon();
+
+    // Each extra double multiplies the epsilon by the double epsilon, at least
+    const Number_t doubleDoubleSpacing = doubleSpacing * std::numeric_limits<double>::epsilon();
+    const Number_t quadDoubleSpacing = doubleDoubleSpacing * std::numeric_limits<double>::epsilon() * std::numeric_limits<double>::epsilon();
+
+    if (allowFloat && texelLength > floatSpacing * FLOAT_MARGIN)
+    {
+        return Precision::FLOAT;
+    }
+    if (texelLength > doubleSpacing * DOUBLE_MARGIN)
+    {
+        return Precision::DOUBLE;
+    }
+    if (deep == Precision::DOUBLE_DOUBLE && texelLength > doubleDoubleSpacing * DOUBLE_MARGIN)
+    {
+        return Precision::DOUBLE_DOUBLE;
+    }
+    if (deep == Precision::FIXED_POINT && fixedFits && texelLength > fixedSpacing * DOUBLE_MARGIN)
+    {
+        return Precision::FIXED_POINT;
+    }
+    if (deep == Precision::QUAD_DOUBLE && texelLength > quadDoubleSpacing * DOUBLE_MARGIN)
+    {
+        return Precision::QUAD_DOUBLE;
+    }
+    return Precision::PERTURBATION;
 }
 
 void Chunk::Draw(std::unique_ptr<Texture>& texture, Chunk_t chunkUMod, Chunk_t chunkVMod, Iteration_t threshold)
@@ -47,7 +713,18 @@ void Chunk::Draw(std::unique_ptr<Texture>& texture, Chunk_t chunkUMod, Chunk_t c
     {
         for (int u = 0; u < SIZE; ++u)
         {
-            texture->Color(u + (chunkUMod * SIZE), v + (chunkVMod * SIZE), iterations[u + v * SIZE], threshold);
+            texture->Color(u + (chunkUMod * SIZE), v + (chunkVMod * SIZE), std::min(iterations[u + v * SIZE], threshold), threshold);
+        }
+    }
+}
+
+void Chunk::DrawPending(std::unique_ptr<Texture>& texture, Chunk_t chunkUMod, Chunk_t chunkVMod)
+{
+    for (int v = 0; v < SIZE; ++v)
+    {
+        for (int u = 0; u < SIZE; ++u)
+        {
+            texture->Pending(u + (chunkUMod * SIZE), v + (chunkVMod * SIZE));
         }
     }
 }
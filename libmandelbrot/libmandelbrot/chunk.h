@@ -2,8 +2,11 @@
 #define CHUNK_H
 
 #include <array>
+#include <atomic>
+#include <vector>
 #include "common.h"
 #include "graphics.h"
+#include "kernel/kernel.h"
 
 namespace mdb {
 
@@ -12,24 +15,113 @@ class Chunk
 {
 public:
 
-    // Writes to owning memory
-    // Non-locking
-    void Compute(Number_t originX, Number_t originY, Number_t texelLength, Iteration_t threshold);
+    // How the texels of a tile are found
+    enum class Strategy
+    {
+        BRUTE_FORCE,        // Every texel iterated
+        SUBDIVIDE,          // Mariani-Silver: rectangles with a uniform border are filled, others split
+        SUBDIVIDE_GUARDED,  // Subdivided, then iterated anyway and compared, for testing
+        BOUNDARY_TRACE      // Edges of iteration bands followed from the tile border, areas they enclose filled
+    };
 
-    // Writes to non-owning memory
+    [[nodiscard]] static const char* StrategyName(Strategy strategy) noexcept;
+
+    // Writes to owning memory, within the given tile only
+    // Non-locking: different tiles of a chunk can be computed concurrently
+    // Origin is rounded to what the precision takes; with PERTURBATION, reference must outlive the call
+    // Texels set in known, u + v * SIZE, already hold their value up to threshold and are kept
+    void Compute(const Coordinate_t& originX, const Coordinate_t& originY, Number_t texelLength, Iteration_t threshold, Precision precision,
+        Strategy strategy, const ReferenceOrbit* reference, int tile, const std::vector<bool>* known = nullptr);
+
+    // Texels stuck at from, the threshold they were computed with, iterated up to threshold, within the given tile
+    // The others escaped before from, so they hold for any threshold above it
+    // Orbits kept at from are carried on, texels known inside left as they are, only the rest start over
+    // FIXED_POINT keeps no orbits, only texels known inside, see KeepsInside
+    void Raise(const Coordinate_t& originX, const Coordinate_t& originY, Number_t texelLength, Iteration_t from, Iteration_t threshold,
+        Precision precision, const ReferenceOrbit* reference, int tile);
+
+    // Float where neighbouring texels stay FLOAT_MARGIN float epsilons apart, if allowed, then double
+    // Float escapes differently from double on a few texels near the set whatever the margin, so it is asked for, not assumed
+    // Past double, deep where it resolves texels: DOUBLE_DOUBLE, FIXED_POINT or QUAD_DOUBLE, and PERTURBATION past those
+    // magnitude is the largest of any coordinate of the area computed
+    [[nodiscard]] static Precision SelectPrecision(Number_t magnitude, Number_t texelLength, bool allowFloat, Precision deep) noexcept;
+
+    // A coordinate of the origin as kernels but PERTURBATION's are given it: rounded to a double, then the rest, most significant first
+    // With StartOf, where they start each texel from
+    static void SplitCoordinate(Coordinate_t value, Number_t& head, Number_t (&tail)[3]);
+
+    // Written before tiles are computed, by the thread dispatching them
+    void SetPrecision(Precision precision) noexcept { this->precision = precision; }
+    [[nodiscard]] Precision GetPrecision() const noexcept { return precision; }
+
+    // Threshold the iterations hold: exact below it, bounded at it, so good for drawing at any threshold up to it
+    // Written before tiles are computed or raised, by the thread dispatching them
+    void SetThreshold(Iteration_t threshold) noexcept { this->threshold = threshold; }
+    [[nodiscard]] Iteration_t Threshold() const noexcept { return threshold; }
+
+    // Bytes orbits of texels left at the threshold may take, for Raise to carry on, 0 for none
+    // Kept with FLOAT and DOUBLE precisions only, texels known inside with FIXED_POINT too, dropped when the chunk is computed again
+    // Written before tiles are computed or raised, by the thread dispatching them
+    void SetOrbitMemory(size_t bytes) noexcept { orbitMemory = bytes; }
+
+    // Polled by the kernels once per row: once set, tiles return early, leaving texels unwritten, so the result is to be thrown away
+    // Written before tiles are computed or raised, by the thread dispatching them, and must outlive them
+    void SetCancel(const std::atomic<bool>* cancelled) noexcept { this->cancelled = cancelled; }
+
+    // Memory given back, for a chunk no longer in view; none of its tiles may be in progress
+    void DropOrbits() noexcept;
+
+    // Summed over tiles of the last Compute or Raise, read once every tile is done
+    [[nodiscard]] KernelStats Stats() const noexcept;
+
+    // Writes to non-owning memory, iterations from threshold up drawn as bounded
     // Consider external locking
     void Draw(std::unique_ptr<Texture>& texture, Chunk_t chunkUMod, Chunk_t ChunkVMod, Iteration_t threshold);
 
+    // The slot of a chunk with nothing to show yet, so none of what it held before is left
+    static void DrawPending(std::unique_ptr<Texture>& texture, Chunk_t chunkUMod, Chunk_t chunkVMod);
+
     constexpr static int SIZE = 256;    // in texels
 
-    typedef uint8_t Status_t;
-    constexpr static Status_t SHOULD_COMPUTE_BIT = 0x1;
-    constexpr static Status_t SHOULD_DRAW_BIT = 0x2;
-    constexpr static Status_t INIT = SHOULD_COMPUTE_BIT;
+    typedef std::array<Iteration_t, SIZE * SIZE> Iterations_t;
+
+    // For keeping elsewhere once every tile is done
+    [[nodiscard]] const Iterations_t& Iterations() const noexcept { return iterations; }
+
+    // Takes iterations kept from a chunk computed in precision up to threshold, with no tile in progress
+    // Orbits are dropped, they belonged to whatever was here before
+    void Load(const Iterations_t& iterations, Iteration_t threshold, Precision precision) noexcept;
+
+    // Unit of scheduling, so a single expensive chunk is spread across workers
+    constexpr static int TILE_SIZE = 32;    // in texels, multiple of kernel width
+    constexpr static int TILES_PER_SIDE = SIZE / TILE_SIZE;
+    constexpr static int TILE_COUNT = TILES_PER_SIDE * TILES_PER_SIDE;
+
+    static_assert(SIZE % TILE_SIZE == 0, "Chunk::SIZE must be a multiple of Chunk::TILE_SIZE");
+
+    // Rectangles of at most this many texels per side are iterated rather than split further
+    // Below it, kernel calls on thin rectangles cost more than the texels filled save
+    constexpr static int SUBDIVIDE_MIN = 16;
+
+    // Raise iterates runs of stuck texels along rows, through gaps shorter than this
+    constexpr static int RAISE_GAP = 8;
+
+    constexpr static Number_t FLOAT_MARGIN = 4096;
+    constexpr static Number_t DOUBLE_MARGIN = 1024;     // Also for the epsilons of multi-double precisions
 
 private:
 
-    std::array<Iteration_t, SIZE * SIZE> iterations;
+    // Arguments for the whole of a tile
+    [[nodiscard]] KernelArgs TileArgs(const Coordinate_t& originX, const Coordinate_t& originY, Number_t texelLength, Iteration_t threshold,
+        Precision precision, const ReferenceOrbit* reference, int tile) noexcept;
+
+    Iterations_t iterations;
+    std::array<KernelStats, TILE_COUNT> tileStats;  // Each written by its own tile only
+    Precision precision = Precision::DOUBLE;
+    Iteration_t threshold = 0;
+    size_t orbitMemory = 0;
+    const std::atomic<bool>* cancelled = nullptr;
+    std::array<OrbitStore, TILE_COUNT> orbits;      // Each written by its own tile only
 };
 
 } // namespace mdb
@@ -0,0 +1,99 @@
+#include <functional>
+#include "chunk_cache.h"
+
+namespace mdb {
+
+size_t ChunkCache::KeyHash::operator()(const Key& key) const noexcept
+{
+    // Neighbouring chunks differ in the low bits of cx or cy, so those are spread apart
+    size_t hash = std::hash<int64_t>()(key.chunk.cx);
+    hash = hash * 0x9e3779b97f4a7c15ull + std::hash<int64_t>()(key.chunk.cy);
+    hash = hash * 0x9e3779b97f4a7c15ull + std::hash<int64_t>()(key.chunk.level);
+    return hash * 0x9e3779b97f4a7c15ull + static_cast<size_t>(key.precision);
+}
+
+void ChunkCache::Store(const ChunkKey& key, const Chunk& chunk)
+{
+    if (memory < ENTRY_BYTES)
+    {
+        return;
+    }
+
+    const Key entryKey = { key, chunk.GetPrecision() };
+
+    auto found = index.find(entryKey);
+    if (found != index.end())
+    {
+        // Reused in place, and moved to the front
+        entries.splice(entries.begin(), entries, found->second);
+    }
+    else
+    {
+        entries.push_front({ entryKey, 0, std::make_unique<Chunk::Iterations_t>() });
+        index.emplace(entryKey, entries.begin());
+    }
+
+    Entry& entry = entries.front();
+    entry.threshold = chunk.Threshold();
+    *entry.iterations = chunk.Iterations();
+
+    Trim();
+}
+
+bool ChunkCache::Load(const ChunkKey& key, Precision precision, Chunk& chunk)
+{
+    auto found = index.find({ key, precision });
+    if (found == index.end())
+    {
+        ++stats.misses;
+        return false;
+    }
+
+    ++stats.hits;
+    entries.splice(entries.begin(), entries, found->second);
+
+    const Entry& entry = entries.front();
+    chunk.Load(*entry.iterations, entry.threshold, precision);
+    return true;
+}
+
+const Chunk::Iterations_t* ChunkCache::Peek(const ChunkKey& key, Precision& precision, Iteration_t& threshold) const
+{
+    // Enum order is the order of precision
+    for (int each = static_cast<int>(Precision::PERTURBATION); each >= static_cast<int>(Precision::FLOAT); --each)
+    {
+        auto found = index.find({ key, static_cast<Precision>(each) });
+        if (found != index.end())
+        {
+            precision = static_cast<Precision>(each);
+            threshold = found->second->threshold;
+            return found->second->iterations.get();
+        }
+    }
+
+    return nullptr;
+}
+
+void ChunkCache::Clear()
+{
+    index.clear();
+    entries.clear();
+}
+
+void ChunkCache::SetMemory(size_t bytes)
+{
+    memory = bytes;
+    Trim();
+}
+
+void ChunkCache::Trim()
+{
+    while (entries.empty() == false && entries.size() * ENTRY_BYTES > memory)
+    {
+        index.erase(entries.back().key);
+        entries.pop_back();
+        ++stats.evictions;
+    }
+}
+
+} // namespace mdb
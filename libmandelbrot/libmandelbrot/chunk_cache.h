@@ -0,0 +1,111 @@
+#ifndef CHUNK_CACHE_H
+#define CHUNK_CACHE_H
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "common.h"
+#include "chunk.h"
+
+namespace mdb {
+
+// Exact address of a chunk: the lattice of its texel length, and its place on it
+// Chunk (cx, cy) has its top-left texel cx chunk lengths right of the lattice anchor, and cy below it
+struct ChunkKey
+{
+    int64_t level = 0;  // One lattice per texel length the Map is set to
+    int64_t cx = 0;
+    int64_t cy = 0;
+
+    friend bool operator==(const ChunkKey& a, const ChunkKey& b) noexcept
+    {
+        return a.level == b.level && a.cx == b.cx && a.cy == b.cy;
+    }
+
+    friend bool operator!=(const ChunkKey& a, const ChunkKey& b) noexcept
+    {
+        return (a == b) == false;
+    }
+};
+
+struct ChunkCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;     // Least recently used chunks dropped for memory
+
+    [[nodiscard]] double HitRate() const noexcept
+    {
+        return (hits + misses == 0) ? 0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+};
+
+// Finished chunks no longer in the Map ring, by key and precision, so panning back finds them
+// Least recently used ones are evicted past the memory given
+// Non-locking: used by the thread calling Map::UpdateState only
+class ChunkCache
+{
+public:
+
+    explicit ChunkCache(size_t memory) :
+        memory(memory) {}
+
+    // Copied in, replacing what the key held in that precision
+    void Store(const ChunkKey& key, const Chunk& chunk);
+
+    // Copied into chunk, with the threshold it was computed up to, if there
+    // Counted as a hit or a miss
+    bool Load(const ChunkKey& key, Precision precision, Chunk& chunk);
+
+    // In any precision, the most precise there, with that precision and the threshold it was computed up to
+    // Neither counted nor made more recent, nullptr if not there
+    [[nodiscard]] const Chunk::Iterations_t* Peek(const ChunkKey& key, Precision& precision, Iteration_t& threshold) const;
+
+    void Clear();
+
+    // Evicts down to it right away
+    void SetMemory(size_t bytes);
+    [[nodiscard]] size_t GetMemory() const noexcept { return memory; }
+
+    [[nodiscard]] size_t Size() const noexcept { return entries.size(); }
+    [[nodiscard]] const ChunkCacheStats& Stats() const noexcept { return stats; }
+
+    constexpr static size_t ENTRY_BYTES = sizeof(Chunk::Iterations_t);
+
+private:
+
+    struct Key
+    {
+        ChunkKey chunk;
+        Precision precision;
+
+        friend bool operator==(const Key& a, const Key& b) noexcept
+        {
+            return a.chunk == b.chunk && a.precision == b.precision;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const noexcept;
+    };
+
+    struct Entry
+    {
+        Key key;
+        Iteration_t threshold;
+        std::unique_ptr<Chunk::Iterations_t> iterations;
+    };
+
+    // Least recently used first out, until within memory
+    void Trim();
+
+    std::list<Entry> entries;   // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    size_t memory;
+    ChunkCacheStats stats;
+};
+
+} // namespace mdb
+
+#endif // !CHUNK_CACHE_H
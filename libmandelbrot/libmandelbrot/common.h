@@ -2,10 +2,12 @@
 #define CONSTANTS_H
 
 #include <cstdint>
+#include "bigfloat.h"
 
 namespace mdb {
 
 typedef double          Number_t;
+typedef BigFloat        Coordinate_t;   // Positions, which outlast double precision when zoomed in deep
 typedef std::uint16_t   Iteration_t;
 typedef std::int16_t    Chunk_t;        // Could technically use int8_t, but char does't play nice with text output
 typedef std::uint32_t   PixelDataIndex_t;
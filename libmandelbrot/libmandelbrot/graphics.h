@@ -49,6 +49,7 @@ public:
     virtual void UnsetAsTarget() = 0;
 
     virtual void Color(int u, int v, Iteration_t iteration, Iteration_t threshold) = 0;
+    virtual void Pending(int u, int v) = 0;     // Nothing to show yet, neither computed nor previewed
     virtual void Update() = 0;
 
     [[nodiscard]] static std::unique_ptr<Texture> Create(
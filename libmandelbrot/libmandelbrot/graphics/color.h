@@ -18,6 +18,7 @@ namespace mdb {
 
     // Set draw color here
     constexpr Color BOUNDED_COLOR = { 0.0f, 0.0f, 0.0f };
+    constexpr Color PENDING_COLOR = { 0.5f, 0.5f, 0.5f };
     constexpr Color UNBOUNDED_COLORS[PALETTE_SIZE + 1] =
     {
         { 0.0f, 0.0f, 1.0f },
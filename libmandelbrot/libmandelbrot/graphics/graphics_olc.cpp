@@ -71,6 +71,16 @@ namespace mdb {
         }
     }
 
+    void OLCDecal::Pending(int u, int v)
+    {
+        olc::Pixel* pixel = sprite.GetData();
+        pixel = &(pixel[u + v * (sprite.width)]);
+
+        pixel->r = PENDING_COLOR.r * 0xff;
+        pixel->g = PENDING_COLOR.g * 0xff;
+        pixel->b = PENDING_COLOR.b * 0xff;
+    }
+
     void OLCDecal::Update()
     {
         decal.Update();
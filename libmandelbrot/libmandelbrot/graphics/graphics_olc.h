@@ -32,6 +32,7 @@ public:
     void UnsetAsTarget() override;  // No decal to decal rendering in olc; falling back to software rendering
 
     void Color(int u, int v, Iteration_t iteration, Iteration_t threshold) override;
+    void Pending(int u, int v) override;
     void Update() override;
 
 private:
@@ -123,6 +123,14 @@ void SDLTexture::Color(int u, int v, Iteration_t iteration, Iteration_t threshol
     }
 }
 
+void SDLTexture::Pending(int u, int v)
+{
+    PixelDataIndex_t index = (u + v * width) * PixelSize();
+    pixelData[index + PixelOffsetR()] = PENDING_COLOR.r * 0xff;
+    pixelData[index + PixelOffsetG()] = PENDING_COLOR.g * 0xff;
+    pixelData[index + PixelOffsetB()] = PENDING_COLOR.b * 0xff;
+}
+
 void SDLTexture::Update()
 {
     SDL_UpdateTexture(texture, NULL, pixelData.data(), width * PixelSize());
@@ -33,6 +33,7 @@ public:
     void UnsetAsTarget() override;
 
     void Color(int u, int v, Iteration_t iteration, Iteration_t threshold) override;
+    void Pending(int u, int v) override;
     void Update() override;
 
 private:
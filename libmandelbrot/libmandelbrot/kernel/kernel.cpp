@@ -0,0 +1,295 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include "kernel/kernel.h"
+
+#if defined(MDB_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace mdb {
+
+typedef KernelStats (*KernelFunction_t)(const KernelArgs&, LaneMode);
+
+/***************************************************************
+    CPU detection
+***************************************************************/
+
+#if defined(MDB_X86) && defined(_MSC_VER)
+
+// Instruction set reported by CPUID, and register state enabled by the OS
+static bool CPUSupports(Kernel kernel)
+{
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool osYmm = (xcr0 & 0x06) == 0x06;
+    const bool osZmm = (xcr0 & 0xe6) == 0xe6;
+
+    bool avx2 = false;
+    bool avx512f = false;
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+        avx512f = (info[1] & (1 << 16)) != 0;
+    }
+
+    switch (kernel)
+    {
+    case Kernel::SCALAR: return true;
+    case Kernel::SSE2: return sse2;
+    case Kernel::AVX2: return avx && avx2 && fma && osYmm;
+    case Kernel::AVX512: return avx512f && osZmm;
+    }
+    return false;
+}
+
+#elif defined(MDB_X86) && defined(__GNUC__)
+
+// Also checks register state enabled by the OS
+static bool CPUSupports(Kernel kernel)
+{
+    __builtin_cpu_init();
+
+    switch (kernel)
+    {
+    case Kernel::SCALAR: return true;
+    case Kernel::SSE2: return __builtin_cpu_supports("sse2");
+    case Kernel::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case Kernel::AVX512: return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+}
+
+#else
+
+static bool CPUSupports(Kernel kernel)
+{
+    return kernel == Kernel::SCALAR;
+}
+
+#endif
+
+/***************************************************************
+    Dispatch
+***************************************************************/
+
+constexpr Kernel KERNELS[] = { Kernel::SCALAR, Kernel::SSE2, Kernel::AVX2, Kernel::AVX512 };
+
+static KernelFunction_t FunctionOf(Kernel kernel) noexcept
+{
+    switch (kernel)
+    {
+    case Kernel::SCALAR: return ComputeScalar;
+    case Kernel::SSE2: return ComputeSSE2;
+    case Kernel::AVX2: return ComputeAVX2;
+    case Kernel::AVX512: return ComputeAVX512;
+    }
+    return ComputeScalar;
+}
+
+static Kernel SelectAtStartup()
+{
+    Kernel best = Kernel::SCALAR;
+    for (Kernel kernel : KERNELS)
+    {
+        if (CPUSupports(kernel))
+        {
+            best = kernel;
+        }
+    }
+
+    MDB_INFO("Best supported kernel: {}", KernelName(best));
+
+    const char* override = std::getenv("MDB_KERNEL");
+    if (override == nullptr)
+    {
+        return best;
+    }
+
+    for (Kernel kernel : KERNELS)
+    {
+        if (std::strcmp(override, KernelName(kernel)) == 0)
+        {
+            if (CPUSupports(kernel))
+            {
+                MDB_INFO("Kernel overridden by MDB_KERNEL: {}", KernelName(kernel));
+                return kernel;
+            }
+
+            MDB_WARN("MDB_KERNEL={} is not supported by this CPU, ignored", override);
+            return best;
+        }
+    }
+
+    MDB_WARN("MDB_KERNEL={} is unknown, ignored", override);
+    return best;
+}
+
+// Function kept alongside, so RunKernel is a single indirect call
+// Lanes are refilled by default: near the set boundary, lockstep groups wait on their slowest texel
+struct Dispatch
+{
+    std::atomic<Kernel> kernel;
+    std::atomic<KernelFunction_t> function;
+    std::atomic<LaneMode> mode{ LaneMode::REFILL };
+
+    Dispatch(Kernel kernel) :
+        kernel(kernel),
+        function(FunctionOf(kernel)) {}
+};
+
+// Initialized on first use, after logging is set up
+static Dispatch& CurrentDispatch()
+{
+    static Dispatch dispatch(SelectAtStartup());
+    return dispatch;
+}
+
+bool SetKernel(Kernel kernel)
+{
+    if (KernelSupported(kernel) == false)
+    {
+        MDB_WARN("Kernel {} is not supported by this CPU", KernelName(kernel));
+        return false;
+    }
+
+    Dispatch& dispatch = CurrentDispatch();
+    dispatch.function.store(FunctionOf(kernel), std::memory_order_relaxed);
+    dispatch.kernel.store(kernel, std::memory_order_relaxed);
+    return true;
+}
+
+Kernel CurrentKernel()
+{
+    return CurrentDispatch().kernel.load(std::memory_order_relaxed);
+}
+
+void SetLaneMode(LaneMode mode)
+{
+    CurrentDispatch().mode.store(mode, std::memory_order_relaxed);
+}
+
+LaneMode CurrentLaneMode()
+{
+    return CurrentDispatch().mode.load(std::memory_order_relaxed);
+}
+
+bool KernelSupported(Kernel kernel)
+{
+    // Detected once
+    static const bool supported[] =
+    {
+        CPUSupports(Kernel::SCALAR),
+        CPUSupports(Kernel::SSE2),
+        CPUSupports(Kernel::AVX2),
+        CPUSupports(Kernel::AVX512)
+    };
+
+    return supported[static_cast<int>(kernel)];
+}
+
+const char* KernelName(Kernel kernel) noexcept
+{
+    switch (kernel)
+    {
+    case Kernel::SCALAR: return "scalar";
+    case Kernel::SSE2: return "sse2";
+    case Kernel::AVX2: return "avx2";
+    case Kernel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+const char* PrecisionName(Precision precision) noexcept
+{
+    switch (precision)
+    {
+    case Precision::FLOAT: return "float";
+    case Precision::DOUBLE: return "double";
+    case Precision::DOUBLE_DOUBLE: return "double-double";
+    case Precision::FIXED_POINT: return "fixed-point";
+    case Precision::QUAD_DOUBLE: return "quad-double";
+    case Precision::PERTURBATION: return "perturbation";
+    }
+    return "unknown";
+}
+
+void OrbitStore::Reset(size_t memory, Iteration_t reached)
+{
+    if (memory == 0)
+    {
+        *this = OrbitStore();
+    }
+    else
+    {
+        texel.clear();
+        zr.clear();
+        zi.clear();
+        sr.clear();
+        si.clear();
+        inside.clear();
+    }
+
+    this->memory = memory;
+    this->reached = reached;
+}
+
+void OrbitStore::Add(int texel, double zr, double zi, double sr, double si)
+{
+    if (Bytes() + ORBIT_BYTES > memory)
+    {
+        return;
+    }
+
+    this->texel.push_back(texel);
+    this->zr.push_back(zr);
+    this->zi.push_back(zi);
+    this->sr.push_back(sr);
+    this->si.push_back(si);
+}
+
+void OrbitStore::AddInside(int texel)
+{
+    if (Bytes() + INSIDE_BYTES > memory)
+    {
+        return;
+    }
+
+    inside.push_back(texel);
+}
+
+TexelStart StartOf(Precision precision, Number_t origin, const Number_t (&tail)[3], Number_t texelLength, int index, bool row) noexcept
+{
+    if (precision == Precision::FIXED_POINT)
+    {
+        return StartFixed(origin, tail, texelLength, index, row);
+    }
+    return StartScalar(precision, origin, tail, texelLength, index, row);
+}
+
+KernelStats RunKernel(const KernelArgs& args)
+{
+    if (args.precision == Precision::FIXED_POINT)
+    {
+        return ComputeFixed(args);
+    }
+    if (args.precision == Precision::PERTURBATION)
+    {
+        return ComputePerturbation(args);
+    }
+
+    Dispatch& dispatch = CurrentDispatch();
+    return dispatch.function.load(std::memory_order_relaxed)(args, dispatch.mode.load(std::memory_order_relaxed));
+}
+
+} // namespace mdb
@@ -0,0 +1,223 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "common.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MDB_X86
+#endif
+
+namespace mdb {
+
+class ReferenceOrbit;
+
+/***************************************************************
+    Escape-time kernels
+***************************************************************/
+
+// Number type iterated with
+enum class Precision
+{
+    FLOAT,          // Twice the vector width, for texels far enough apart
+    DOUBLE,
+    DOUBLE_DOUBLE,  // Sums of two doubles, about 32 digits
+    FIXED_POINT,    // 128-bit integers with FIXED_FRACTION_BITS below the point, about 36 digits
+    QUAD_DOUBLE,    // Sums of four doubles, about 64 digits
+    PERTURBATION    // Doubles, as differences from a reference orbit, for texels closer than doubles resolve
+};
+
+[[nodiscard]] const char* PrecisionName(Precision precision) noexcept;
+
+// Orbits of texels left at the threshold without being found inside, so a higher threshold can carry on from them
+// Structure of arrays, for lanes to load from; doubles hold float orbits exactly
+// Iterations done and the cycle detection schedule follow from reached, the same for every orbit
+struct OrbitStore
+{
+    Iteration_t reached = 0;    // Threshold it was filled at
+    size_t memory = 0;          // Bytes texel indices and orbits may take at most
+
+    std::vector<int> texel;     // u + v * pitch, of each orbit
+    std::vector<double> zr;
+    std::vector<double> zi;
+    std::vector<double> sr;     // Point saved for cycle detection
+    std::vector<double> si;
+
+    std::vector<int> inside;    // Texels known to never escape, skipped or found cyclic, with nothing to carry on
+
+    constexpr static size_t ORBIT_BYTES = sizeof(int) + 4 * sizeof(double);
+    constexpr static size_t INSIDE_BYTES = sizeof(int);
+
+    [[nodiscard]] size_t Size() const noexcept { return texel.size(); }
+    [[nodiscard]] size_t Bytes() const noexcept { return texel.size() * ORBIT_BYTES + inside.size() * INSIDE_BYTES; }
+
+    // Emptied, memory given back if none is allowed
+    void Reset(size_t memory, Iteration_t reached);
+
+    // Dropped past memory: that texel is iterated from the start next time
+    void Add(int texel, double zr, double zi, double sr, double si);
+    void AddInside(int texel);
+};
+
+// Precisions whose kernels fill and carry on an OrbitStore
+// The others keep more of z than a double holds
+[[nodiscard]] constexpr bool KeepsOrbits(Precision precision) noexcept
+{
+    return precision == Precision::FLOAT || precision == Precision::DOUBLE;
+}
+
+// Precisions whose kernels add texels known inside to an OrbitStore
+// FIXED_POINT adds no orbits, so its other stuck texels start over when raised
+[[nodiscard]] constexpr bool KeepsInside(Precision precision) noexcept
+{
+    return KeepsOrbits(precision) || precision == Precision::FIXED_POINT;
+}
+
+// A rectangle of texels within a chunk, and the numbers it represents
+struct KernelArgs
+{
+    Number_t originX;           // Texel (0, 0) of the chunk, relative to the reference with PERTURBATION
+    Number_t originY;
+    Number_t texelLength;
+    Iteration_t threshold;
+    Precision precision;
+    const ReferenceOrbit* reference = nullptr;  // With PERTURBATION only
+
+    // Rest of the origin, most significant first, with DOUBLE_DOUBLE, FIXED_POINT and QUAD_DOUBLE
+    Number_t originTailX[3] = {};
+    Number_t originTailY[3] = {};
+
+    int beginU;                 // Rectangle, in texels of the chunk
+    int beginV;
+    int width;                  // Lockstep lanes need a multiple of 32, refill lanes are used otherwise
+    int height;
+
+    Iteration_t* iterations;    // Texel (0, 0) of the chunk
+    int pitch;                  // Iterations per row
+
+    // With precisions that KeepsInside only, resume with those that KeepsOrbits only
+    OrbitStore* orbits = nullptr;       // Texels left at threshold are added to it
+    const OrbitStore* resume = nullptr; // Its orbits are carried on up to threshold, instead of the rectangle
+
+    // With any precision
+    const std::vector<int>* texels = nullptr;   // u + v * pitch, iterated from the start instead of the rectangle
+
+    // Polled once per row, or a row's worth of texels: once set, the kernel returns, leaving the rest unwritten
+    const std::atomic<bool>* cancelled = nullptr;
+};
+
+[[nodiscard]] inline bool Cancelled(const KernelArgs& args) noexcept
+{
+    return args.cancelled != nullptr && args.cancelled->load(std::memory_order_relaxed);
+}
+
+// Sign and 7 integer bits: squares of orbits that just escaped radius 2, from anywhere within it, still fit
+constexpr int FIXED_FRACTION_BITS = 120;
+
+// Orbits are checked for cycles, Brent style: compared to a point saved at every power of two iterations
+// In texel lengths
+constexpr Number_t PERIOD_TOLERANCE = 1.0 / 1024;
+
+// What was done for a rectangle, summed by the caller as needed
+struct KernelStats
+{
+    uint32_t skippedTexels = 0;     // Inside the main cardioid or period-2 bulb, set to threshold without iterating
+    uint32_t periodicTexels = 0;    // Found cyclic, set to threshold before reaching it
+    uint32_t filledTexels = 0;      // Filled by the caller from texels around, never given to a kernel
+    uint32_t guardMismatches = 0;   // Filled texels that iterating gave a different value to, when checked
+    uint32_t glitchedTexels = 0;    // Lost precision against the given reference orbit, iterated again against another
+    uint32_t extraReferences = 0;   // Reference orbits computed for glitched texels
+    uint32_t resumedTexels = 0;     // Carried on from an OrbitStore, rather than iterated from the start
+    uint32_t reusedTexels = 0;      // Known by the caller from another computation, never given to a kernel
+
+    KernelStats& operator+=(const KernelStats& other) noexcept
+    {
+        skippedTexels += other.skippedTexels;
+        periodicTexels += other.periodicTexels;
+        filledTexels += other.filledTexels;
+        guardMismatches += other.guardMismatches;
+        glitchedTexels += other.glitchedTexels;
+        extraReferences += other.extraReferences;
+        resumedTexels += other.resumedTexels;
+        reusedTexels += other.reusedTexels;
+        return *this;
+    }
+};
+
+// Every kernel writes the same results as the scalar one at the same precision, bit for bit
+// Vectorized kernels interleave two vectors to hide latency
+// Multi-double precisions run in lockstep whatever the lane mode, on all but SSE2 which lacks FMA
+enum class Kernel
+{
+    SCALAR,
+    SSE2,       // 2 doubles or 4 floats per instruction
+    AVX2,       // 4 doubles or 8 floats per instruction, with FMA
+    AVX512      // 8 doubles or 16 floats per instruction
+};
+
+// How vector lanes are kept busy, with no effect on results or on the scalar kernel
+// Orbits are kept and carried on by refill lanes, so given an OrbitStore or a list of texels, kernels refill anyway
+enum class LaneMode
+{
+    LOCKSTEP,   // A group of adjacent texels iterates until all of them finish
+    REFILL      // A finished lane takes the next texel right away, results are scattered back
+};
+
+// The best kernel the CPU supports is chosen once, on first use
+// Environment variable MDB_KERNEL overrides it, with one of: scalar, sse2, avx2, avx512
+
+// Used by all chunks computed afterwards
+// Returns false and keeps the current kernel if the CPU doesn't support it
+bool SetKernel(Kernel kernel);
+[[nodiscard]] Kernel CurrentKernel();
+
+void SetLaneMode(LaneMode mode);
+[[nodiscard]] LaneMode CurrentLaneMode();
+
+[[nodiscard]] bool KernelSupported(Kernel kernel);
+[[nodiscard]] const char* KernelName(Kernel kernel) noexcept;
+
+// Computes with the current kernel, or with ComputeFixed or ComputePerturbation for their precision
+KernelStats RunKernel(const KernelArgs& args);
+
+// Bits of one coordinate of a texel, as kernels start iterating from it
+struct TexelStart
+{
+    std::array<uint64_t, 4> bits = {};
+
+    [[nodiscard]] bool operator==(const TexelStart& other) const noexcept { return bits == other.bits; }
+};
+
+// Real part of texel index of a row, or imaginary part of texel index of a column, as kernels of precision take it
+// origin and tail are those of KernelArgs; texels starting alike in both parts are iterated alike, in whatever chunk
+// Not for PERTURBATION, which starts from the reference
+[[nodiscard]] TexelStart StartOf(Precision precision, Number_t origin, const Number_t (&tail)[3], Number_t texelLength, int index, bool row) noexcept;
+
+// Each variant is in its own translation unit, compiled for its instruction set
+// Call only if supported
+KernelStats ComputeScalar(const KernelArgs& args, LaneMode mode);
+KernelStats ComputeSSE2(const KernelArgs& args, LaneMode mode);
+KernelStats ComputeAVX2(const KernelArgs& args, LaneMode mode);
+KernelStats ComputeAVX512(const KernelArgs& args, LaneMode mode);
+
+// Integer only, so the same on every CPU
+// Skips the main cardioid and period-2 bulb, but keeps no orbits, see KeepsInside
+KernelStats ComputeFixed(const KernelArgs& args);
+
+// StartOf, for ComputeFixed and for the others, which all start like ComputeScalar
+[[nodiscard]] TexelStart StartFixed(Number_t origin, const Number_t (&tail)[3], Number_t texelLength, int index, bool row) noexcept;
+[[nodiscard]] TexelStart StartScalar(Precision precision, Number_t origin, const Number_t (&tail)[3], Number_t texelLength, int index, bool row) noexcept;
+
+// Scalar, on every CPU
+// Glitched texels are iterated again against extra reference orbits, shared through the given one, up to MAX_EXTRA_REFERENCES tries
+KernelStats ComputePerturbation(const KernelArgs& args);
+
+constexpr int MAX_EXTRA_REFERENCES = 8;
+
+} // namespace mdb
+
+#endif // !KERNEL_H
@@ -0,0 +1,102 @@
+#include <cmath>
+#include "kernel/kernel.h"
+
+#ifdef MDB_X86
+
+#include <immintrin.h>
+
+// Contraction turned off: a fused a * b + c rounds differently
+// FMA is only used where called for, by multi-double products
+#if defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "kernel/kernel_simd.h"
+
+namespace mdb {
+
+// Local to this translation unit, see kernel_simd.h
+namespace {
+
+struct AVX2Double
+{
+    typedef double Scalar;
+    typedef __m256d Reg;
+    typedef __m256d Mask;     // All-ones lanes
+    constexpr static int WIDTH = 4;
+
+    static Reg Set1(Scalar x) { return _mm256_set1_pd(x); }
+    static Reg Add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+    static Reg Fma(Reg a, Reg b, Reg c) { return _mm256_fmadd_pd(a, b, c); }
+    static Reg Abs(Reg a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    static Mask Greater(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static Mask And(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+    static Mask AndNot(Mask a, Mask b) { return _mm256_andnot_pd(a, b); }
+    static Mask Or(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+    static Reg Select(Mask mask, Reg a, Reg b) { return _mm256_blendv_pd(b, a, mask); }
+    static bool Any(Mask mask) { return _mm256_movemask_pd(mask) != 0; }
+    static int Count(Mask mask) { return PopCount(_mm256_movemask_pd(mask)); }
+    static Reg Load(const Scalar* p) { return _mm256_loadu_pd(p); }
+    static void Store(Scalar* p, Reg a) { _mm256_storeu_pd(p, a); }
+};
+
+struct AVX2Float
+{
+    typedef float Scalar;
+    typedef __m256 Reg;
+    typedef __m256 Mask;      // All-ones lanes
+    constexpr static int WIDTH = 8;
+
+    static Reg Set1(Scalar x) { return _mm256_set1_ps(x); }
+    static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+    static Reg Abs(Reg a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static Mask Greater(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Mask And(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+    static Mask AndNot(Mask a, Mask b) { return _mm256_andnot_ps(a, b); }
+    static Mask Or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+    static Reg Select(Mask mask, Reg a, Reg b) { return _mm256_blendv_ps(b, a, mask); }
+    static bool Any(Mask mask) { return _mm256_movemask_ps(mask) != 0; }
+    static int Count(Mask mask) { return PopCount(_mm256_movemask_ps(mask)); }
+    static Reg Load(const Scalar* p) { return _mm256_loadu_ps(p); }
+    static void Store(Scalar* p, Reg a) { _mm256_storeu_ps(p, a); }
+};
+
+// Instruction set, see ComputeVectorized
+struct AVX2
+{
+    typedef AVX2Double Double;
+    typedef AVX2Float Float;
+    constexpr static bool MULTI = true;
+};
+
+} // namespace
+
+KernelStats ComputeAVX2(const KernelArgs& args, LaneMode mode)
+{
+    return ComputeVectorized<AVX2>(args, mode);
+}
+
+} // namespace mdb
+
+#if defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#else // !MDB_X86
+
+namespace mdb {
+
+KernelStats ComputeAVX2(const KernelArgs& args, LaneMode mode)
+{
+    return ComputeScalar(args, mode);
+}
+
+} // namespace mdb
+
+#endif // MDB_X86
@@ -0,0 +1,102 @@
+#include <cmath>
+#include "kernel/kernel.h"
+
+#ifdef MDB_X86
+
+#include <immintrin.h>
+
+// Contraction turned off: a fused a * b + c rounds differently
+// FMA is only used where called for, by multi-double products
+#if defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC target("avx512f")
+#endif
+
+#include "kernel/kernel_simd.h"
+
+namespace mdb {
+
+// Local to this translation unit, see kernel_simd.h
+namespace {
+
+struct AVX512Double
+{
+    typedef double Scalar;
+    typedef __m512d Reg;
+    typedef __mmask8 Mask;    // One bit per lane
+    constexpr static int WIDTH = 8;
+
+    static Reg Set1(Scalar x) { return _mm512_set1_pd(x); }
+    static Reg Add(Reg a, Reg b) { return _mm512_add_pd(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm512_sub_pd(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm512_mul_pd(a, b); }
+    static Reg Fma(Reg a, Reg b, Reg c) { return _mm512_fmadd_pd(a, b, c); }
+    static Reg Abs(Reg a) { return _mm512_abs_pd(a); }
+    static Mask Greater(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+    static Mask And(Mask a, Mask b) { return a & b; }
+    static Mask AndNot(Mask a, Mask b) { return ~a & b; }
+    static Mask Or(Mask a, Mask b) { return a | b; }
+    static Reg Select(Mask mask, Reg a, Reg b) { return _mm512_mask_blend_pd(mask, b, a); }
+    static bool Any(Mask mask) { return mask != 0; }
+    static int Count(Mask mask) { return PopCount(mask); }
+    static Reg Load(const Scalar* p) { return _mm512_loadu_pd(p); }
+    static void Store(Scalar* p, Reg a) { _mm512_storeu_pd(p, a); }
+};
+
+struct AVX512Float
+{
+    typedef float Scalar;
+    typedef __m512 Reg;
+    typedef __mmask16 Mask;   // One bit per lane
+    constexpr static int WIDTH = 16;
+
+    static Reg Set1(Scalar x) { return _mm512_set1_ps(x); }
+    static Reg Add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm512_sub_ps(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm512_mul_ps(a, b); }
+    static Reg Abs(Reg a) { return _mm512_abs_ps(a); }
+    static Mask Greater(Reg a, Reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static Mask And(Mask a, Mask b) { return a & b; }
+    static Mask AndNot(Mask a, Mask b) { return ~a & b; }
+    static Mask Or(Mask a, Mask b) { return a | b; }
+    static Reg Select(Mask mask, Reg a, Reg b) { return _mm512_mask_blend_ps(mask, b, a); }
+    static bool Any(Mask mask) { return mask != 0; }
+    static int Count(Mask mask) { return PopCount(mask); }
+    static Reg Load(const Scalar* p) { return _mm512_loadu_ps(p); }
+    static void Store(Scalar* p, Reg a) { _mm512_storeu_ps(p, a); }
+};
+
+// Instruction set, see ComputeVectorized
+struct AVX512
+{
+    typedef AVX512Double Double;
+    typedef AVX512Float Float;
+    constexpr static bool MULTI = true;
+};
+
+} // namespace
+
+KernelStats ComputeAVX512(const KernelArgs& args, LaneMode mode)
+{
+    return ComputeVectorized<AVX512>(args, mode);
+}
+
+} // namespace mdb
+
+#if defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#else // !MDB_X86
+
+namespace mdb {
+
+KernelStats ComputeAVX512(const KernelArgs& args, LaneMode mode)
+{
+    return ComputeScalar(args, mode);
+}
+
+} // namespace mdb
+
+#endif // MDB_X86
@@ -0,0 +1,298 @@
+#include <cmath>
+#include "kernel/kernel.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#include "kernel/kernel_interior.h"
+
+namespace mdb {
+
+// 64 x 64 bit product, high and low halves
+static void Multiply64(uint64_t a, uint64_t b, uint64_t& high, uint64_t& low) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    high = static_cast<uint64_t>(product >> 64);
+    low = static_cast<uint64_t>(product);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    low = _umul128(a, b, &high);
+#else
+    const uint64_t aLow = a & 0xffffffffu;
+    const uint64_t aHigh = a >> 32;
+    const uint64_t bLow = b & 0xffffffffu;
+    const uint64_t bHigh = b >> 32;
+
+    const uint64_t ll = aLow * bLow;
+    const uint64_t lh = aLow * bHigh;
+    const uint64_t hl = aHigh * bLow;
+    const uint64_t hh = aHigh * bHigh;
+
+    const uint64_t middle = (ll >> 32) + (lh & 0xffffffffu) + (hl & 0xffffffffu);
+    low = (middle << 32) | (ll & 0xffffffffu);
+    high = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+#endif
+}
+
+// Two's complement 128-bit fixed point, FRACTION bits below the point
+// Integer operations only, so results are the same on every compiler and CPU
+template<int FRACTION>
+struct FixedPoint
+{
+    static_assert(FRACTION > 64 && FRACTION < 128, "Fraction must take the low limb and part of the high one");
+
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    FixedPoint() = default;
+
+    // For constants, see InCardioidOrBulb
+    explicit FixedPoint(double value) noexcept : FixedPoint(FromDouble(value)) {}
+
+    [[nodiscard]] bool Negative() const noexcept { return (high >> 63) != 0; }
+
+    // Bits below the format are dropped, towards negative infinity
+    static FixedPoint FromDouble(double value) noexcept
+    {
+        FixedPoint result;
+        if (value == 0)
+        {
+            return result;
+        }
+
+        // value = mantissa * 2^(exponent - 53), with a 53-bit integer mantissa
+        int exponent;
+        const double fraction = std::frexp(std::fabs(value), &exponent);
+        const uint64_t mantissa = static_cast<uint64_t>(std::ldexp(fraction, 53));
+
+        // Position of bit 0 of the mantissa in the format
+        const int shift = exponent - 53 + FRACTION;
+        if (shift >= 64)
+        {
+            result.high = mantissa << (shift - 64);
+        }
+        else if (shift > 0)
+        {
+            result.high = mantissa >> (64 - shift);
+            result.low = mantissa << shift;
+        }
+        else if (shift > -64)
+        {
+            result.low = mantissa >> -shift;
+        }
+
+        return (value < 0) ? -result : result;
+    }
+
+    FixedPoint operator-() const noexcept
+    {
+        FixedPoint result;
+        result.low = ~low + 1;
+        result.high = ~high + (result.low == 0 ? 1 : 0);
+        return result;
+    }
+
+    friend FixedPoint operator+(const FixedPoint& a, const FixedPoint& b) noexcept
+    {
+        FixedPoint result;
+        result.low = a.low + b.low;
+        result.high = a.high + b.high + (result.low < a.low ? 1 : 0);
+        return result;
+    }
+
+    friend FixedPoint operator-(const FixedPoint& a, const FixedPoint& b) noexcept
+    {
+        FixedPoint result;
+        result.low = a.low - b.low;
+        result.high = a.high - b.high - (a.low < b.low ? 1 : 0);
+        return result;
+    }
+
+    // Signed, through magnitudes: the 256-bit product shifted down by FRACTION, truncated
+    friend FixedPoint operator*(const FixedPoint& a, const FixedPoint& b) noexcept
+    {
+        const bool negative = a.Negative() != b.Negative();
+        const FixedPoint x = a.Negative() ? -a : a;
+        const FixedPoint y = b.Negative() ? -b : b;
+
+        uint64_t llHigh, llLow, lhHigh, lhLow, hlHigh, hlLow, hhHigh, hhLow;
+        Multiply64(x.low, y.low, llHigh, llLow);
+        Multiply64(x.low, y.high, lhHigh, lhLow);
+        Multiply64(x.high, y.low, hlHigh, hlLow);
+        Multiply64(x.high, y.high, hhHigh, hhLow);
+
+        // Limbs 1 to 3 of the product, limb 0 only matters through llHigh
+        uint64_t limb1 = llHigh + lhLow;
+        uint64_t carry = (limb1 < llHigh) ? 1 : 0;
+        limb1 += hlLow;
+        carry += (limb1 < hlLow) ? 1 : 0;
+
+        uint64_t limb2 = lhHigh + carry;
+        carry = (limb2 < carry) ? 1 : 0;
+        limb2 += hlHigh;
+        carry += (limb2 < hlHigh) ? 1 : 0;
+        limb2 += hhLow;
+        carry += (limb2 < hhLow) ? 1 : 0;
+
+        const uint64_t limb3 = hhHigh + carry;
+
+        // Shift right by FRACTION = 64 + s
+        constexpr int s = FRACTION - 64;
+        FixedPoint result;
+        result.low = (limb1 >> s) | (limb2 << (64 - s));
+        result.high = (limb2 >> s) | (limb3 << (64 - s));
+
+        return negative ? -result : result;
+    }
+
+    friend bool operator<(const FixedPoint& a, const FixedPoint& b) noexcept
+    {
+        const int64_t aHigh = static_cast<int64_t>(a.high);
+        const int64_t bHigh = static_cast<int64_t>(b.high);
+        return (aHigh != bHigh) ? (aHigh < bHigh) : (a.low < b.low);
+    }
+};
+
+// Same loop as the scalar kernel, in fixed point
+// Coordinates are summed from the origin and its tails, each rounded into the format
+// Orbits take more than a double, so none are kept: texels known inside are added to args.orbits, the others start over when raised
+template<int FRACTION>
+static KernelStats ComputeFixedWith(const KernelArgs& args)
+{
+    typedef FixedPoint<FRACTION> Fixed;
+
+    KernelStats stats;
+
+    const Fixed four = Fixed::FromDouble(2 * 2);
+    const Fixed tolerance = Fixed::FromDouble(PeriodTolerance<double>(args));
+
+    Fixed originX = Fixed::FromDouble(args.originX);
+    Fixed originY = Fixed::FromDouble(args.originY);
+    for (int i = 0; i < 3; ++i)
+    {
+        originX = originX + Fixed::FromDouble(args.originTailX[i]);
+        originY = originY + Fixed::FromDouble(args.originTailY[i]);
+    }
+
+    auto inside = [&](int texel)
+    {
+        args.iterations[texel] = args.threshold;
+        if (args.orbits != nullptr)
+        {
+            args.orbits->AddInside(texel);
+        }
+    };
+
+    auto start = [&](int texel)
+    {
+        const Fixed cr = originX + Fixed::FromDouble((texel % args.pitch) * args.texelLength);
+        const Fixed ci = originY - Fixed::FromDouble((texel / args.pitch) * args.texelLength);
+
+        // Known not to escape; within radius 2, see Chunk::SelectPrecision, so the test stays within the format
+        if (InCardioidOrBulb(cr, ci))
+        {
+            inside(texel);
+            ++stats.skippedTexels;
+            return;
+        }
+
+        Fixed zr;
+        Fixed zi;
+        Fixed zr2;
+        Fixed zi2;
+        Fixed sr;
+        Fixed si;
+        int saveAt = 1;     // In iterations done, doubled on each save
+
+        Iteration_t it = 0;
+        for (; it < args.threshold; ++it)
+        {
+            const Fixed zrzi = zr * zi;
+            zi = zrzi + zrzi + ci;
+            zr = zr2 - zi2 + cr;
+            zr2 = zr * zr;
+            zi2 = zi * zi;
+
+            if (four < zr2 + zi2)
+            {
+                break;
+            }
+
+            // Back to where it was: cyclic, never escapes
+            const Fixed dr = zr - sr;
+            const Fixed di = zi - si;
+            if ((dr.Negative() ? -dr : dr) < tolerance && (di.Negative() ? -di : di) < tolerance)
+            {
+                inside(texel);
+                ++stats.periodicTexels;
+                return;
+            }
+
+            if (it + 1 == saveAt)
+            {
+                sr = zr;
+                si = zi;
+                saveAt *= 2;
+            }
+        }
+
+        args.iterations[texel] = it;
+    };
+
+    if (args.texels != nullptr)
+    {
+        for (size_t i = 0; i < args.texels->size(); ++i)
+        {
+            if (i % args.pitch == 0 && Cancelled(args))
+            {
+                break;
+            }
+
+            start((*args.texels)[i]);
+        }
+        return stats;
+    }
+
+    for (int texelV = args.beginV; texelV < args.beginV + args.height; ++texelV)
+    {
+        if (Cancelled(args))
+        {
+            break;
+        }
+
+        for (int texelU = args.beginU; texelU < args.beginU + args.width; ++texelU)
+        {
+            start(texelU + texelV * args.pitch);
+        }
+    }
+
+    return stats;
+}
+
+KernelStats ComputeFixed(const KernelArgs& args)
+{
+    return ComputeFixedWith<FIXED_FRACTION_BITS>(args);
+}
+
+// As ComputeFixedWith sums the origin, then start does
+TexelStart StartFixed(Number_t origin, const Number_t (&tail)[3], Number_t texelLength, int index, bool row) noexcept
+{
+    typedef FixedPoint<FIXED_FRACTION_BITS> Fixed;
+
+    Fixed start = Fixed::FromDouble(origin);
+    for (int i = 0; i < 3; ++i)
+    {
+        start = start + Fixed::FromDouble(tail[i]);
+    }
+
+    const Fixed offset = Fixed::FromDouble(index * texelLength);
+    start = row ? start + offset : start - offset;
+
+    TexelStart result;
+    result.bits[0] = start.high;
+    result.bits[1] = start.low;
+    return result;
+}
+
+} // namespace mdb
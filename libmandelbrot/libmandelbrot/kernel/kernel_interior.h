@@ -0,0 +1,56 @@
+#ifndef KERNEL_INTERIOR_H
+#define KERNEL_INTERIOR_H
+
+// Tests for points known to never escape
+// Include after the pragmas of the translation unit, like kernel_simd.h:
+// everything is in an anonymous namespace, so each kernel keeps its own rounding and instruction set
+
+#include "kernel/kernel.h"
+
+namespace mdb {
+namespace {
+
+// Main cardioid: q * (q + (x - 1/4)) < y^2 / 4, with q = (x - 1/4)^2 + y^2
+// Period-2 bulb: (x + 1)^2 + y^2 < 1/16
+// Strict, so points on either boundary still iterate
+// Vectorized kernels do the same operations in the same order
+template<typename T>
+static bool InCardioidOrBulb(T x, T y) noexcept
+{
+    const T y2 = y * y;
+
+    const T xq = x - static_cast<T>(0.25);
+    const T q = xq * xq + y2;
+    if (q * (q + xq) < y2 * static_cast<T>(0.25))
+    {
+        return true;
+    }
+
+    const T x1 = x + static_cast<T>(1);
+    return (x1 * x1 + y2 < static_cast<T>(0.0625));
+}
+
+// An orbit back within this distance of a saved point, on both parts, is taken as cyclic
+// Scaled to the texel, so it stays well below what is visible at any zoom
+template<typename T>
+static T PeriodTolerance(const KernelArgs& args) noexcept
+{
+    return static_cast<T>(args.texelLength * PERIOD_TOLERANCE);
+}
+
+// Saves for cycle detection come after every power of two iterations
+// For an orbit carried on, the first one past what it has done
+inline int NextSaveAt(int done) noexcept
+{
+    int saveAt = 1;
+    while (saveAt <= done)
+    {
+        saveAt *= 2;
+    }
+    return saveAt;
+}
+
+} // namespace
+} // namespace mdb
+
+#endif // !KERNEL_INTERIOR_H
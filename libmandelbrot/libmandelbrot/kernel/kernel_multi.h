@@ -0,0 +1,405 @@
+#ifndef KERNEL_MULTI_H
+#define KERNEL_MULTI_H
+
+// Multi-double numbers: unevaluated sums of N doubles, most significant first
+// Written over a vector type like kernel_simd.h, and without branches, so every lane does the same operations
+// Include after the pragmas of the translation unit: error-free transformations are only exact without contraction
+// In an anonymous namespace like kernel_simd.h, ScalarDouble included
+
+// V provides what kernel_simd.h lists, with Scalar double, plus:
+//  Fma(a, b, c), a * b + c rounded once
+
+#include <cmath>
+#include "kernel/kernel.h"
+#include "kernel/kernel_interior.h"
+
+namespace mdb {
+namespace {
+
+// Plain doubles as vectors of one, for the scalar kernel and for setting lanes up
+struct ScalarDouble
+{
+    typedef double Scalar;
+    typedef double Reg;
+    typedef bool Mask;
+    constexpr static int WIDTH = 1;
+
+    static Reg Set1(Scalar x) { return x; }
+    static Reg Add(Reg a, Reg b) { return a + b; }
+    static Reg Sub(Reg a, Reg b) { return a - b; }
+    static Reg Mul(Reg a, Reg b) { return a * b; }
+    static Reg Fma(Reg a, Reg b, Reg c) { return std::fma(a, b, c); }
+    static Reg Abs(Reg a) { return std::fabs(a); }
+    static Mask Greater(Reg a, Reg b) { return a > b; }
+    static Mask And(Mask a, Mask b) { return a && b; }
+    static Mask AndNot(Mask a, Mask b) { return !a && b; }
+    static Mask Or(Mask a, Mask b) { return a || b; }
+    static Reg Select(Mask mask, Reg a, Reg b) { return mask ? a : b; }
+    static bool Any(Mask mask) { return mask; }
+    static int Count(Mask mask) { return mask ? 1 : 0; }
+    static Reg Load(const Scalar* p) { return *p; }
+    static void Store(Scalar* p, Reg a) { *p = a; }
+};
+
+template<typename V, int N>
+struct MultiDouble
+{
+    static_assert(N == 2 || N == 4, "Double-double and quad-double only");
+
+    typename V::Reg terms[N];   // Non-overlapping, most significant first
+};
+
+/***************************************************************
+    Error-free transformations
+***************************************************************/
+
+// a + b = sum + error exactly
+template<typename V>
+static typename V::Reg TwoSum(typename V::Reg a, typename V::Reg b, typename V::Reg& error)
+{
+    typedef typename V::Reg Reg;
+
+    const Reg sum = V::Add(a, b);
+    const Reg bPart = V::Sub(sum, a);
+    error = V::Add(V::Sub(a, V::Sub(sum, bPart)), V::Sub(b, bPart));
+    return sum;
+}
+
+// TwoSum, given |a| >= |b| or a == 0
+template<typename V>
+static typename V::Reg QuickTwoSum(typename V::Reg a, typename V::Reg b, typename V::Reg& error)
+{
+    const typename V::Reg sum = V::Add(a, b);
+    error = V::Sub(b, V::Sub(sum, a));
+    return sum;
+}
+
+// a * b = product + error exactly, the error from a single fused operation
+template<typename V>
+static typename V::Reg TwoProduct(typename V::Reg a, typename V::Reg b, typename V::Reg& error)
+{
+    const typename V::Reg product = V::Mul(a, b);
+    error = V::Fma(a, b, V::Sub(V::Set1(0), product));
+    return product;
+}
+
+// (a, b, c) becomes their sum and two errors, in that order of magnitude
+template<typename V>
+static void ThreeSum(typename V::Reg& a, typename V::Reg& b, typename V::Reg& c)
+{
+    typename V::Reg t2;
+    typename V::Reg t3;
+    const typename V::Reg t1 = TwoSum<V>(a, b, t2);
+    a = TwoSum<V>(c, t1, t3);
+    b = TwoSum<V>(t2, t3, c);
+}
+
+// ThreeSum, with the last error folded into the second
+template<typename V>
+static void ThreeSum2(typename V::Reg& a, typename V::Reg& b, typename V::Reg c)
+{
+    typename V::Reg t2;
+    typename V::Reg t3;
+    const typename V::Reg t1 = TwoSum<V>(a, b, t2);
+    a = TwoSum<V>(c, t1, t3);
+    b = V::Add(t2, t3);
+}
+
+// Five overlapping terms back to four that don't overlap
+// Sums from the bottom up, then compresses from the top down, without the branches on zero terms
+template<typename V>
+static void Renormalize(typename V::Reg& c0, typename V::Reg& c1, typename V::Reg& c2, typename V::Reg& c3, typename V::Reg c4)
+{
+    typename V::Reg s = QuickTwoSum<V>(c3, c4, c4);
+    s = QuickTwoSum<V>(c2, s, c3);
+    s = QuickTwoSum<V>(c1, s, c2);
+    c0 = QuickTwoSum<V>(c0, s, c1);
+
+    c1 = QuickTwoSum<V>(c1, c2, c2);
+    c2 = QuickTwoSum<V>(c2, c3, c3);
+    c3 = V::Add(c3, c4);
+}
+
+/***************************************************************
+    Arithmetic
+***************************************************************/
+
+template<typename V, int N>
+static MultiDouble<V, N> MultiFrom(typename V::Reg x)
+{
+    MultiDouble<V, N> result;
+    result.terms[0] = x;
+    for (int i = 1; i < N; ++i)
+    {
+        result.terms[i] = V::Set1(0);
+    }
+    return result;
+}
+
+template<typename V, int N>
+static MultiDouble<V, N> MultiNegate(const MultiDouble<V, N>& a)
+{
+    MultiDouble<V, N> result;
+    for (int i = 0; i < N; ++i)
+    {
+        result.terms[i] = V::Sub(V::Set1(0), a.terms[i]);
+    }
+    return result;
+}
+
+// Double-double adds in full, quad-double the way the QD library does without IEEE rounding
+template<typename V, int N>
+static MultiDouble<V, N> MultiAdd(const MultiDouble<V, N>& a, const MultiDouble<V, N>& b)
+{
+    typedef typename V::Reg Reg;
+    MultiDouble<V, N> result;
+
+    if constexpr (N == 2)
+    {
+        Reg e1;
+        Reg e2;
+        Reg s = TwoSum<V>(a.terms[0], b.terms[0], e1);
+        const Reg t = TwoSum<V>(a.terms[1], b.terms[1], e2);
+        e1 = V::Add(e1, t);
+        s = QuickTwoSum<V>(s, e1, e1);
+        e1 = V::Add(e1, e2);
+        result.terms[0] = QuickTwoSum<V>(s, e1, result.terms[1]);
+    }
+    else
+    {
+        Reg t0;
+        Reg t1;
+        Reg t2;
+        Reg t3;
+        Reg s0 = TwoSum<V>(a.terms[0], b.terms[0], t0);
+        Reg s1 = TwoSum<V>(a.terms[1], b.terms[1], t1);
+        Reg s2 = TwoSum<V>(a.terms[2], b.terms[2], t2);
+        Reg s3 = TwoSum<V>(a.terms[3], b.terms[3], t3);
+
+        s1 = TwoSum<V>(s1, t0, t0);
+        ThreeSum<V>(s2, t0, t1);
+        ThreeSum2<V>(s3, t0, t2);
+        t0 = V::Add(V::Add(t0, t1), t3);
+
+        Renormalize<V>(s0, s1, s2, s3, t0);
+        result.terms[0] = s0;
+        result.terms[1] = s1;
+        result.terms[2] = s2;
+        result.terms[3] = s3;
+    }
+
+    return result;
+}
+
+template<typename V, int N>
+static MultiDouble<V, N> MultiSub(const MultiDouble<V, N>& a, const MultiDouble<V, N>& b)
+{
+    return MultiAdd<V, N>(a, MultiNegate<V, N>(b));
+}
+
+// Products below the last term are left out
+template<typename V, int N>
+static MultiDouble<V, N> MultiMul(const MultiDouble<V, N>& a, const MultiDouble<V, N>& b)
+{
+    typedef typename V::Reg Reg;
+    MultiDouble<V, N> result;
+
+    if constexpr (N == 2)
+    {
+        Reg error;
+        const Reg product = TwoProduct<V>(a.terms[0], b.terms[0], error);
+        error = V::Add(error, V::Add(V::Mul(a.terms[0], b.terms[1]), V::Mul(a.terms[1], b.terms[0])));
+        result.terms[0] = QuickTwoSum<V>(product, error, result.terms[1]);
+    }
+    else
+    {
+        const Reg* x = a.terms;
+        const Reg* y = b.terms;
+
+        Reg q0;
+        Reg q1;
+        Reg q2;
+        Reg q3;
+        Reg q4;
+        Reg q5;
+        Reg p0 = TwoProduct<V>(x[0], y[0], q0);
+        Reg p1 = TwoProduct<V>(x[0], y[1], q1);
+        Reg p2 = TwoProduct<V>(x[1], y[0], q2);
+        Reg p3 = TwoProduct<V>(x[0], y[2], q3);
+        Reg p4 = TwoProduct<V>(x[1], y[1], q4);
+        Reg p5 = TwoProduct<V>(x[2], y[0], q5);
+
+        ThreeSum<V>(p1, p2, q0);
+
+        // (p2, q1, q2) + (p3, p4, p5), as three terms
+        ThreeSum<V>(p2, q1, q2);
+        ThreeSum<V>(p3, p4, p5);
+        Reg t0;
+        Reg t1;
+        const Reg s0 = TwoSum<V>(p2, p3, t0);
+        Reg s1 = TwoSum<V>(q1, p4, t1);
+        Reg s2 = V::Add(q2, p5);
+        s1 = TwoSum<V>(s1, t0, t0);
+        s2 = V::Add(s2, V::Add(t0, t1));
+
+        // Order eps^3 terms, plain products are enough
+        Reg small = V::Add(V::Mul(x[0], y[3]), V::Mul(x[1], y[2]));
+        small = V::Add(small, V::Add(V::Mul(x[2], y[1]), V::Mul(x[3], y[0])));
+        small = V::Add(small, V::Add(V::Add(q0, q3), V::Add(q4, q5)));
+        s1 = V::Add(s1, small);
+
+        Reg r0 = p0;
+        Reg r1 = p1;
+        Reg r2 = s0;
+        Reg r3 = s1;
+        Renormalize<V>(r0, r1, r2, r3, s2);
+        result.terms[0] = r0;
+        result.terms[1] = r1;
+        result.terms[2] = r2;
+        result.terms[3] = r3;
+    }
+
+    return result;
+}
+
+/***************************************************************
+    Kernel
+***************************************************************/
+
+// Lanes take consecutive texels of the rectangle in row-major order, or of the list, and iterate until every one has finished
+// Any width: spare lanes of the last group start finished
+// Leading terms decide escape, which is far from any rounding; cycles are checked on the full difference
+template<typename V, int N>
+static KernelStats ComputeMulti(const KernelArgs& args)
+{
+    typedef typename V::Reg Reg;
+    typedef typename V::Mask Mask;
+    typedef MultiDouble<V, N> Multi;
+    typedef MultiDouble<ScalarDouble, N> Single;
+    constexpr int WIDTH = V::WIDTH;
+
+    KernelStats stats;
+
+    const Reg four = V::Set1(2 * 2);
+    const Reg none = V::Set1(0);
+    const Mask all = V::Greater(four, none);
+    const Reg tolerance = V::Set1(PeriodTolerance<double>(args));
+
+    // Leading terms within this of each other may be within tolerance, given the tails of orbits inside radius 2
+    const Reg nearTolerance = V::Set1(PeriodTolerance<double>(args) + 16 * std::numeric_limits<double>::epsilon());
+
+    Single originX;
+    Single originY;
+    originX.terms[0] = args.originX;
+    originY.terms[0] = args.originY;
+    for (int i = 1; i < N; ++i)
+    {
+        originX.terms[i] = args.originTailX[i - 1];
+        originY.terms[i] = args.originTailY[i - 1];
+    }
+
+    const std::vector<int>* texels = args.texels;
+    const int texelCount = (texels != nullptr) ? static_cast<int>(texels->size()) : args.width * args.height;
+    const int pollEvery = (texels != nullptr) ? args.pitch : args.width;
+
+    // u + v * pitch of the texel-th one taken
+    auto indexOf = [&](int texel)
+    {
+        return (texels != nullptr) ? (*texels)[texel] : args.beginU + texel % args.width + (args.beginV + texel / args.width) * args.pitch;
+    };
+
+    for (int first = 0; first < texelCount; first += WIDTH)
+    {
+        // Once per row, or per group where rows are narrower
+        if (first % pollEvery < WIDTH && Cancelled(args))
+        {
+            break;
+        }
+
+        double lanesR[N][WIDTH];
+        double lanesI[N][WIDTH];
+        double valid[WIDTH];
+
+        for (int lane = 0; lane < WIDTH; ++lane)
+        {
+            // Spare lanes repeat the last texel, and are never active
+            const int index = indexOf((first + lane < texelCount) ? first + lane : texelCount - 1);
+            const int texelU = index % args.pitch;
+            const int texelV = index / args.pitch;
+
+            const Single cr = MultiAdd<ScalarDouble, N>(originX, MultiFrom<ScalarDouble, N>(texelU * args.texelLength));
+            const Single ci = MultiSub<ScalarDouble, N>(originY, MultiFrom<ScalarDouble, N>(texelV * args.texelLength));
+            for (int i = 0; i < N; ++i)
+            {
+                lanesR[i][lane] = cr.terms[i];
+                lanesI[i][lane] = ci.terms[i];
+            }
+            valid[lane] = (first + lane < texelCount) ? 1 : 0;
+        }
+
+        Multi cr;
+        Multi ci;
+        for (int i = 0; i < N; ++i)
+        {
+            cr.terms[i] = V::Load(lanesR[i]);
+            ci.terms[i] = V::Load(lanesI[i]);
+        }
+
+        Multi zr = MultiFrom<V, N>(none);
+        Multi zi = MultiFrom<V, N>(none);
+        Multi sr = zr;
+        Multi si = zi;
+        Mask active = V::Greater(V::Load(valid), none);
+        Mask periodic = V::AndNot(all, all);
+        Reg result = V::Set1(args.threshold);
+        int saveAt = 1;     // Same for all lanes, in iterations done
+
+        for (Iteration_t it = 0; V::Any(active) && it < args.threshold; ++it)
+        {
+            const Multi zr2 = MultiMul<V, N>(zr, zr);
+            const Multi zi2 = MultiMul<V, N>(zi, zi);
+            const Multi zrzi = MultiMul<V, N>(zr, zi);
+            zi = MultiAdd<V, N>(MultiAdd<V, N>(zrzi, zrzi), ci);
+            zr = MultiAdd<V, N>(MultiSub<V, N>(zr2, zi2), cr);
+
+            const Reg magnitude = V::Add(V::Mul(zr.terms[0], zr.terms[0]), V::Mul(zi.terms[0], zi.terms[0]));
+            Mask escaped = V::And(V::Greater(magnitude, four), active);
+            result = V::Select(escaped, V::Set1(it), result);
+            active = V::AndNot(escaped, active);
+
+            // Back to where it was: cyclic, left at threshold
+            // Leading terms rule out most lanes before any full difference is taken
+            Mask near = V::And(V::Greater(nearTolerance, V::Abs(V::Sub(zr.terms[0], sr.terms[0]))), active);
+            if (V::Any(near))
+            {
+                near = V::And(V::Greater(tolerance, V::Abs(MultiSub<V, N>(zr, sr).terms[0])), near);
+                near = V::And(V::Greater(tolerance, V::Abs(MultiSub<V, N>(zi, si).terms[0])), near);
+                periodic = V::Or(periodic, near);
+                active = V::AndNot(near, active);
+            }
+
+            if (it + 1 == saveAt)
+            {
+                sr = zr;
+                si = zi;
+                saveAt *= 2;
+            }
+        }
+
+        double results[WIDTH];
+        V::Store(results, result);
+        stats.periodicTexels += V::Count(periodic);
+
+        for (int lane = 0; lane < WIDTH && first + lane < texelCount; ++lane)
+        {
+            args.iterations[indexOf(first + lane)] = static_cast<Iteration_t>(results[lane]);
+        }
+    }
+
+    return stats;
+}
+
+} // namespace
+} // namespace mdb
+
+#endif // !KERNEL_MULTI_H
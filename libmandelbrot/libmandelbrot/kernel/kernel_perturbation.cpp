@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "kernel/kernel.h"
+#include "reference_orbit.h"
+
+namespace mdb {
+
+// c = reference + (dcr, dci), z = Z + d, iterating d' = (2Z + d) * d + dc
+// Returns false if glitched: z came too close to zero relative to Z, or outlived the reference orbit
+static bool Perturb(const ReferenceOrbit& reference, Number_t dcr, Number_t dci, Iteration_t threshold, Iteration_t& result)
+{
+    const Number_t* zr = reference.Real();
+    const Number_t* zi = reference.Imag();
+    const Number_t* glitchLimit = reference.GlitchLimit();
+    const int length = reference.Length();
+
+    Number_t dr = 0;
+    Number_t di = 0;
+
+    for (int it = 0; it < threshold; ++it)
+    {
+        if (it >= length)
+        {
+            result = static_cast<Iteration_t>(it);
+            return false;
+        }
+
+        const Number_t tr = 2 * zr[it] + dr;
+        const Number_t ti = 2 * zi[it] + di;
+        const Number_t nextR = tr * dr - ti * di + dcr;
+        const Number_t nextI = tr * di + ti * dr + dci;
+        dr = nextR;
+        di = nextI;
+
+        const Number_t r = zr[it + 1] + dr;
+        const Number_t i = zi[it + 1] + di;
+        const Number_t magnitude = r * r + i * i;
+
+        if (magnitude > 2 * 2)
+        {
+            result = static_cast<Iteration_t>(it);
+            return true;
+        }
+
+        if (magnitude < glitchLimit[it + 1])
+        {
+            result = static_cast<Iteration_t>(it);
+            return false;
+        }
+    }
+
+    result = threshold;
+    return true;
+}
+
+KernelStats ComputePerturbation(const KernelArgs& args)
+{
+    KernelStats stats;
+    std::vector<int> glitched;  // Texel indices within the chunk
+
+    auto dcOf = [&](int texel, Number_t& dcr, Number_t& dci)
+    {
+        dcr = args.originX + (texel % args.pitch) * args.texelLength;
+        dci = args.originY - (texel / args.pitch) * args.texelLength;
+    };
+
+    auto start = [&](int texel)
+    {
+        Number_t dcr;
+        Number_t dci;
+        dcOf(texel, dcr, dci);
+
+        if (Perturb(*args.reference, dcr, dci, args.threshold, args.iterations[texel]) == false)
+        {
+            glitched.push_back(texel);
+        }
+    };
+
+    if (args.texels != nullptr)
+    {
+        for (size_t i = 0; i < args.texels->size(); ++i)
+        {
+            if (i % args.pitch == 0 && Cancelled(args))
+            {
+                return stats;
+            }
+
+            start((*args.texels)[i]);
+        }
+    }
+    else
+    {
+        for (int texelV = args.beginV; texelV < args.beginV + args.height; ++texelV)
+        {
+            if (Cancelled(args))
+            {
+                return stats;
+            }
+
+            for (int texelU = args.beginU; texelU < args.beginU + args.width; ++texelU)
+            {
+                start(texelU + texelV * args.pitch);
+            }
+        }
+    }
+
+    stats.glitchedTexels = static_cast<uint32_t>(glitched.size());
+
+    // Texels glitch in blobs around a point the reference doesn't pass near, so a texel in the middle
+    // of the list makes a good reference for the others; those still glitched try again
+    // Blobs span tiles, so the nearest extra another tile computed is tried first, if the texel picked isn't glitched against it
+    // Left with the values of their last try when out of tries
+    std::vector<const ReferenceOrbit*> tried;
+    std::vector<int> stillGlitched;
+    for (int attempt = 0; attempt < MAX_EXTRA_REFERENCES && glitched.empty() == false; ++attempt)
+    {
+        // A reference orbit takes longer than a row
+        if (Cancelled(args))
+        {
+            break;
+        }
+
+        Number_t pickR;
+        Number_t pickI;
+        dcOf(glitched[glitched.size() / 2], pickR, pickI);
+
+        ReferenceOrbit::Extra extra = {};
+        Number_t nearest = std::numeric_limits<Number_t>::max();
+        for (const ReferenceOrbit::Extra& shared : args.reference->Extras())
+        {
+            const Number_t distance = (shared.dx - pickR) * (shared.dx - pickR) + (shared.dy - pickI) * (shared.dy - pickI);
+            if (distance < nearest && std::find(tried.begin(), tried.end(), shared.orbit.get()) == tried.end())
+            {
+                extra = shared;
+                nearest = distance;
+            }
+        }
+
+        Iteration_t pick;
+        if (extra.orbit == nullptr || Perturb(*extra.orbit, pickR - extra.dx, pickI - extra.dy, args.threshold, pick) == false)
+        {
+            if (extra.orbit != nullptr)
+            {
+                tried.push_back(extra.orbit.get());
+            }
+
+            extra = args.reference->AddExtra(pickR, pickI);
+            ++stats.extraReferences;
+        }
+        tried.push_back(extra.orbit.get());
+
+        stillGlitched.clear();
+        for (int texel : glitched)
+        {
+            Number_t dcr;
+            Number_t dci;
+            dcOf(texel, dcr, dci);
+
+            if (Perturb(*extra.orbit, dcr - extra.dx, dci - extra.dy, args.threshold, args.iterations[texel]) == false)
+            {
+                stillGlitched.push_back(texel);
+            }
+        }
+        glitched.swap(stillGlitched);
+    }
+
+    return stats;
+}
+
+} // namespace mdb
@@ -0,0 +1,230 @@
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include "kernel/kernel.h"
+
+// Contraction turned off: a fused a * b + c rounds differently from other kernels
+#if defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "kernel/kernel_interior.h"
+#include "kernel/kernel_multi.h"
+
+namespace mdb {
+
+template<typename T>
+static constexpr T absSquared(const std::complex<T>& c) noexcept
+{
+    return (c.real() * c.real() + c.imag() * c.imag());
+}
+
+// Reference for all other kernels
+template<typename T>
+static KernelStats ComputeScalarWith(const KernelArgs& args)
+{
+    typedef std::complex<T> Complex_t;
+
+    KernelStats stats;
+    const T tolerance = PeriodTolerance<T>(args);
+
+    auto coordinate = [&](int texel) -> Complex_t
+    {
+        return
+        {
+            static_cast<T>(args.originX + (texel % args.pitch) * args.texelLength),
+            static_cast<T>(args.originY - (texel / args.pitch) * args.texelLength)
+        };
+    };
+
+    // From iteration it, with the orbit as left there
+    auto iterate = [&](int texel, Complex_t dc, Complex_t c, Complex_t saved, int saveAt, Iteration_t it)
+    {
+        for (; it < args.threshold; ++it)
+        {
+            c = c * c + dc;
+
+            if (absSquared(c) > static_cast<T>(2 * 2))
+            {
+                break;
+            }
+
+            // Back to where it was: cyclic, never escapes
+            if (std::abs(c.real() - saved.real()) < tolerance && std::abs(c.imag() - saved.imag()) < tolerance)
+            {
+                args.iterations[texel] = args.threshold;
+                ++stats.periodicTexels;
+                if (args.orbits != nullptr)
+                {
+                    args.orbits->AddInside(texel);
+                }
+                return;
+            }
+
+            if (it + 1 == saveAt)
+            {
+                saved = c;
+                saveAt *= 2;
+            }
+        }
+
+        args.iterations[texel] = it;
+        if (it == args.threshold && args.orbits != nullptr)
+        {
+            args.orbits->Add(texel, c.real(), c.imag(), saved.real(), saved.imag());
+        }
+    };
+
+    if (args.resume != nullptr)
+    {
+        const OrbitStore& resume = *args.resume;
+        const int saveAt = NextSaveAt(resume.reached);
+
+        for (size_t i = 0; i < resume.Size(); ++i)
+        {
+            if (i % args.pitch == 0 && Cancelled(args))
+            {
+                break;
+            }
+
+            const int texel = resume.texel[i];
+            const Complex_t c = { static_cast<T>(resume.zr[i]), static_cast<T>(resume.zi[i]) };
+            const Complex_t saved = { static_cast<T>(resume.sr[i]), static_cast<T>(resume.si[i]) };
+            iterate(texel, coordinate(texel), c, saved, saveAt, resume.reached);
+        }
+
+        stats.resumedTexels += static_cast<uint32_t>(resume.Size());
+        return stats;
+    }
+
+    // From the start
+    auto start = [&](int texel)
+    {
+        const Complex_t dc = coordinate(texel);
+
+        // Known not to escape
+        if (InCardioidOrBulb(dc.real(), dc.imag()))
+        {
+            args.iterations[texel] = args.threshold;
+            ++stats.skippedTexels;
+            if (args.orbits != nullptr)
+            {
+                args.orbits->AddInside(texel);
+            }
+            return;
+        }
+
+        iterate(texel, dc, { 0.0, 0.0 }, { 0.0, 0.0 }, 1, 0);
+    };
+
+    if (args.texels != nullptr)
+    {
+        for (size_t i = 0; i < args.texels->size(); ++i)
+        {
+            if (i % args.pitch == 0 && Cancelled(args))
+            {
+                break;
+            }
+
+            start((*args.texels)[i]);
+        }
+        return stats;
+    }
+
+    for (int texelV = args.beginV; texelV < args.beginV + args.height; ++texelV)
+    {
+        if (Cancelled(args))
+        {
+            break;
+        }
+
+        for (int texelU = args.beginU; texelU < args.beginU + args.width; ++texelU)
+        {
+            start(texelU + texelV * args.pitch);
+        }
+    }
+
+    return stats;
+}
+
+// As ComputeMulti sets its lanes up
+template<int N>
+static TexelStart StartMulti(Number_t origin, const Number_t (&tail)[3], Number_t offset, bool row)
+{
+    typedef MultiDouble<ScalarDouble, N> Single;
+
+    Single start;
+    start.terms[0] = origin;
+    for (int i = 1; i < N; ++i)
+    {
+        start.terms[i] = tail[i - 1];
+    }
+    start = row ? MultiAdd<ScalarDouble, N>(start, MultiFrom<ScalarDouble, N>(offset)) : MultiSub<ScalarDouble, N>(start, MultiFrom<ScalarDouble, N>(offset));
+
+    TexelStart result;
+    for (int i = 0; i < N; ++i)
+    {
+        std::memcpy(&result.bits[i], &start.terms[i], sizeof(double));
+    }
+    return result;
+}
+
+// As coordinate in ComputeScalarWith, and kernel_simd.h, set their lanes up
+TexelStart StartScalar(Precision precision, Number_t origin, const Number_t (&tail)[3], Number_t texelLength, int index, bool row) noexcept
+{
+    const Number_t offset = index * texelLength;
+    const Number_t start = row ? origin + offset : origin - offset;
+
+    TexelStart result;
+    if (precision == Precision::FLOAT)
+    {
+        const float single = static_cast<float>(start);
+        uint32_t bits;
+        std::memcpy(&bits, &single, sizeof(float));
+        result.bits[0] = bits;
+    }
+    else if (precision == Precision::DOUBLE_DOUBLE)
+    {
+        result = StartMulti<2>(origin, tail, offset, row);
+    }
+    else if (precision == Precision::QUAD_DOUBLE)
+    {
+        result = StartMulti<4>(origin, tail, offset, row);
+    }
+    else
+    {
+        std::memcpy(&result.bits[0], &start, sizeof(double));
+    }
+    return result;
+}
+
+// No vectors, so no lanes
+KernelStats ComputeScalar(const KernelArgs& args, LaneMode)
+{
+    if (args.precision == Precision::FLOAT)
+    {
+        return ComputeScalarWith<float>(args);
+    }
+    else if (args.precision == Precision::DOUBLE_DOUBLE)
+    {
+        return ComputeMulti<ScalarDouble, 2>(args);
+    }
+    else if (args.precision == Precision::QUAD_DOUBLE)
+    {
+        return ComputeMulti<ScalarDouble, 4>(args);
+    }
+    else if (args.precision == Precision::FIXED_POINT)
+    {
+        return ComputeFixed(args);
+    }
+    else if (args.precision == Precision::PERTURBATION)
+    {
+        return ComputePerturbation(args);
+    }
+    else
+    {
+        return ComputeScalarWith<double>(args);
+    }
+}
+
+} // namespace mdb
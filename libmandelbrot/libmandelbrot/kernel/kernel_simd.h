@@ -0,0 +1,496 @@
+#ifndef KERNEL_SIMD_H
+#define KERNEL_SIMD_H
+
+// Escape-time loop written once over a vector type, and the kernel of an instruction set built from it
+// Include inside the target region of the translation unit instantiating it,
+// so that the instruction set of V is available to the inlined operations
+// Everything is in an anonymous namespace, and so must the types given to it be: no copy compiled for one
+// instruction set can then stand in for another at link time, on a CPU that lacks it
+
+// V provides:
+//  Scalar (float or double), Reg, Mask, WIDTH
+//  Set1(Scalar), Add, Sub, Mul, Abs, Greater (to Mask)
+//  And, AndNot(a, b) i.e. ~a & b, Or, Any, Count (of set lanes), on Mask
+//  Select(mask, a, b), Load(const Scalar*), Store(Scalar*, Reg)
+
+// I, the instruction set of a kernel, provides:
+//  Double and Float, types V as above
+//  MULTI, whether Double also provides what kernel_multi.h asks for, so multi-double precisions run in vectors
+
+// Coordinates are computed in Number_t then rounded to Scalar,
+// so the double instantiations do the same operations as the scalar kernel
+
+#include "kernel/kernel.h"
+#include "kernel/kernel_interior.h"
+#include "kernel/kernel_multi.h"
+
+namespace mdb {
+namespace {
+
+// Once per group of lanes, so a plain loop will do
+static int PopCount(unsigned int bits) noexcept
+{
+    int count = 0;
+    for (; bits != 0; bits &= bits - 1)
+    {
+        ++count;
+    }
+    return count;
+}
+
+// InCardioidOrBulb for every lane, with the same operations
+template<typename V>
+static typename V::Mask VectorInCardioidOrBulb(typename V::Reg x, typename V::Reg y)
+{
+    typedef typename V::Scalar Scalar;
+    typedef typename V::Reg Reg;
+
+    const Reg y2 = V::Mul(y, y);
+
+    const Reg xq = V::Sub(x, V::Set1(static_cast<Scalar>(0.25)));
+    const Reg q = V::Add(V::Mul(xq, xq), y2);
+    const Reg cardioid = V::Mul(q, V::Add(q, xq));
+
+    const Reg x1 = V::Add(x, V::Set1(static_cast<Scalar>(1)));
+    const Reg bulb = V::Add(V::Mul(x1, x1), y2);
+
+    return V::Or(
+        V::Greater(V::Mul(y2, V::Set1(static_cast<Scalar>(0.25))), cardioid),
+        V::Greater(V::Set1(static_cast<Scalar>(0.0625)), bulb)
+    );
+}
+
+// All lanes iterate until every lane has escaped
+// UNROLL independent vectors are interleaved to hide instruction latency
+// Width must be a multiple of V::WIDTH * UNROLL
+template<typename V, int UNROLL>
+KernelStats ComputeLockstep(const KernelArgs& args)
+{
+    typedef typename V::Scalar Scalar;
+    typedef typename V::Reg Reg;
+    typedef typename V::Mask Mask;
+    constexpr int GROUP = V::WIDTH * UNROLL;
+
+    KernelStats stats;
+
+    const Reg four = V::Set1(static_cast<Scalar>(2 * 2));
+    const Reg none = V::Set1(0);
+    const Mask all = V::Greater(four, none);
+    const Reg tolerance = V::Set1(PeriodTolerance<Scalar>(args));
+
+    for (int texelV = args.beginV; texelV < args.beginV + args.height; ++texelV)
+    {
+        if (Cancelled(args))
+        {
+            break;
+        }
+
+        Iteration_t* row = args.iterations + texelV * args.pitch;
+
+        const Reg ci = V::Set1(static_cast<Scalar>(args.originY - texelV * args.texelLength));
+
+        for (int texelU = args.beginU; texelU < args.beginU + args.width; texelU += GROUP)
+        {
+            Scalar lanes[GROUP];
+            for (int i = 0; i < GROUP; ++i)
+            {
+                lanes[i] = static_cast<Scalar>(args.originX + (texelU + i) * args.texelLength);
+            }
+
+            Reg cr[UNROLL];
+            Reg zr[UNROLL];
+            Reg zi[UNROLL];
+            Reg zr2[UNROLL];
+            Reg zi2[UNROLL];
+            Reg sr[UNROLL];
+            Reg si[UNROLL];
+            Mask active[UNROLL];
+            Mask periodic[UNROLL];
+            Reg result[UNROLL];
+            bool anyActive = false;
+            int saveAt = 1;     // Same for all lanes, in iterations done
+
+            for (int k = 0; k < UNROLL; ++k)
+            {
+                cr[k] = V::Load(lanes + k * V::WIDTH);
+                zr[k] = none;
+                zi[k] = none;
+                zr2[k] = none;
+                zi2[k] = none;
+                sr[k] = none;
+                si[k] = none;
+                periodic[k] = V::AndNot(all, all);
+                result[k] = V::Set1(args.threshold);
+
+                // Known not to escape: left at threshold
+                Mask inside = VectorInCardioidOrBulb<V>(cr[k], ci);
+                stats.skippedTexels += V::Count(inside);
+                active[k] = V::AndNot(inside, all);
+                anyActive |= V::Any(active[k]);
+            }
+
+            for (Iteration_t it = 0; anyActive && it < args.threshold; ++it)
+            {
+                const Reg current = V::Set1(it);
+                anyActive = false;
+
+                for (int k = 0; k < UNROLL; ++k)
+                {
+                    // z = z * z + c, with the products of the complex multiply kept separate
+                    Reg zrzi = V::Mul(zr[k], zi[k]);
+                    zi[k] = V::Add(V::Add(zrzi, zrzi), ci);
+                    zr[k] = V::Add(V::Sub(zr2[k], zi2[k]), cr[k]);
+                    zr2[k] = V::Mul(zr[k], zr[k]);
+                    zi2[k] = V::Mul(zi[k], zi[k]);
+
+                    Mask escaped = V::And(V::Greater(V::Add(zr2[k], zi2[k]), four), active[k]);
+                    result[k] = V::Select(escaped, current, result[k]);
+                    active[k] = V::AndNot(escaped, active[k]);
+
+                    // Back to where it was: cyclic, left at threshold
+                    // Imaginary parts only compared once some real part is close, which is rare outside the set
+                    Mask near = V::And(V::Greater(tolerance, V::Abs(V::Sub(zr[k], sr[k]))), active[k]);
+                    if (V::Any(near))
+                    {
+                        Mask cyclic = V::And(V::Greater(tolerance, V::Abs(V::Sub(zi[k], si[k]))), near);
+                        periodic[k] = V::Or(periodic[k], cyclic);
+                        active[k] = V::AndNot(cyclic, active[k]);
+                    }
+
+                    anyActive |= V::Any(active[k]);
+                }
+
+                if (it + 1 == saveAt)
+                {
+                    for (int k = 0; k < UNROLL; ++k)
+                    {
+                        sr[k] = zr[k];
+                        si[k] = zi[k];
+                    }
+                    saveAt *= 2;
+                }
+            }
+
+            for (int k = 0; k < UNROLL; ++k)
+            {
+                V::Store(lanes + k * V::WIDTH, result[k]);
+                stats.periodicTexels += V::Count(periodic[k]);
+            }
+            for (int i = 0; i < GROUP; ++i)
+            {
+                row[texelU + i] = static_cast<Iteration_t>(lanes[i]);
+            }
+        }
+    }
+
+    return stats;
+}
+
+// A lane that finishes is refilled with the next texel of the rectangle right away,
+// so lanes don't idle while a slow neighbour runs up to threshold
+// Lane state goes through memory only when some lane finishes, which is also where orbits are stored and carried on
+template<typename V, int UNROLL>
+KernelStats ComputeRefill(const KernelArgs& args)
+{
+    typedef typename V::Scalar Scalar;
+    typedef typename V::Reg Reg;
+    typedef typename V::Mask Mask;
+    constexpr int LANES = V::WIDTH * UNROLL;
+
+    KernelStats stats;
+
+    // Texels of the rectangle in row-major order, or of the list, or the orbits to carry on
+    const OrbitStore* resume = args.resume;
+    const std::vector<int>* texels = args.texels;
+    const int texelCount =
+        (resume != nullptr) ? static_cast<int>(resume->Size()) :
+        (texels != nullptr) ? static_cast<int>(texels->size()) :
+        args.width * args.height;
+    int next = 0;
+
+    Scalar cr[LANES];
+    Scalar ci[LANES];
+    Scalar zr[LANES];
+    Scalar zi[LANES];
+    Scalar zr2[LANES];
+    Scalar zi2[LANES];
+    Scalar sr[LANES];       // Saved for cycle detection
+    Scalar si[LANES];
+    Scalar saveMark[LANES]; // Saved once count is past it: a power of two minus 0.5
+    Scalar count[LANES];    // Iterations done, exact up to threshold in float too
+    int texel[LANES];       // u + v * pitch, -1 for a lane with nothing left to do
+
+    // Lanes at work finish their texel, none takes another
+    const int pollEvery = (resume != nullptr || texels != nullptr) ? args.pitch : args.width;
+    int pollAt = 0;
+
+    auto refill = [&](int lane)
+    {
+        zr[lane] = 0;
+        zi[lane] = 0;
+        zr2[lane] = 0;
+        zi2[lane] = 0;
+
+        if (next >= pollAt)
+        {
+            pollAt = next + pollEvery;
+            if (Cancelled(args))
+            {
+                next = texelCount;
+            }
+        }
+
+        if (resume != nullptr)
+        {
+            // As left at reached, squares taken again with the same rounding
+            if (next < texelCount)
+            {
+                const int index = resume->texel[next];
+                cr[lane] = static_cast<Scalar>(args.originX + (index % args.pitch) * args.texelLength);
+                ci[lane] = static_cast<Scalar>(args.originY - (index / args.pitch) * args.texelLength);
+                zr[lane] = static_cast<Scalar>(resume->zr[next]);
+                zi[lane] = static_cast<Scalar>(resume->zi[next]);
+                zr2[lane] = zr[lane] * zr[lane];
+                zi2[lane] = zi[lane] * zi[lane];
+                sr[lane] = static_cast<Scalar>(resume->sr[next]);
+                si[lane] = static_cast<Scalar>(resume->si[next]);
+                saveMark[lane] = static_cast<Scalar>(NextSaveAt(resume->reached)) - static_cast<Scalar>(0.5);
+                count[lane] = resume->reached;
+                texel[lane] = index;
+
+                ++next;
+                ++stats.resumedTexels;
+                return;
+            }
+        }
+        else
+        {
+            for (; next < texelCount; ++next)
+            {
+                const int index = (texels != nullptr) ? (*texels)[next] : args.beginU + next % args.width + (args.beginV + next / args.width) * args.pitch;
+                const int texelU = index % args.pitch;
+                const int texelV = index / args.pitch;
+
+                const Scalar x = static_cast<Scalar>(args.originX + texelU * args.texelLength);
+                const Scalar y = static_cast<Scalar>(args.originY - texelV * args.texelLength);
+
+                // Known not to escape: written right away, without taking a lane
+                if (InCardioidOrBulb(x, y))
+                {
+                    args.iterations[index] = args.threshold;
+                    ++stats.skippedTexels;
+                    if (args.orbits != nullptr)
+                    {
+                        args.orbits->AddInside(index);
+                    }
+                    continue;
+                }
+
+                cr[lane] = x;
+                ci[lane] = y;
+                sr[lane] = 0;
+                si[lane] = 0;
+                saveMark[lane] = static_cast<Scalar>(0.5);
+                count[lane] = 0;
+                texel[lane] = index;
+
+                ++next;
+                return;
+            }
+        }
+
+        // Stays at 0, never reaches threshold, and is never near its saved point
+        const Scalar infinity = std::numeric_limits<Scalar>::infinity();
+        cr[lane] = 0;
+        ci[lane] = 0;
+        sr[lane] = infinity;
+        si[lane] = infinity;
+        saveMark[lane] = infinity;
+        count[lane] = -infinity;
+        texel[lane] = -1;
+    };
+
+    // A rectangle inside the cardioid or bulb leaves every lane idle
+    bool anyWorking = false;
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        refill(lane);
+        anyWorking |= (texel[lane] >= 0);
+    }
+
+    const Scalar four = static_cast<Scalar>(2 * 2);
+    const Reg vone = V::Set1(1);
+    const Reg vfour = V::Set1(four);
+    const Reg vhalf = V::Set1(static_cast<Scalar>(0.5));
+    const Reg vlimit = V::Set1(args.threshold - static_cast<Scalar>(0.5));
+    const Reg vperiodic = V::Set1(args.threshold + static_cast<Scalar>(1));   // Past any count reached by iterating
+    const Reg vtolerance = V::Set1(PeriodTolerance<Scalar>(args));
+
+    Reg vcr[UNROLL];
+    Reg vci[UNROLL];
+    Reg vzr[UNROLL];
+    Reg vzi[UNROLL];
+    Reg vzr2[UNROLL];
+    Reg vzi2[UNROLL];
+    Reg vsr[UNROLL];
+    Reg vsi[UNROLL];
+    Reg vsaveMark[UNROLL];
+    Reg vcount[UNROLL];
+
+    while (anyWorking)
+    {
+        for (int k = 0; k < UNROLL; ++k)
+        {
+            vcr[k] = V::Load(cr + k * V::WIDTH);
+            vci[k] = V::Load(ci + k * V::WIDTH);
+            vzr[k] = V::Load(zr + k * V::WIDTH);
+            vzi[k] = V::Load(zi + k * V::WIDTH);
+            vzr2[k] = V::Load(zr2 + k * V::WIDTH);
+            vzi2[k] = V::Load(zi2 + k * V::WIDTH);
+            vsr[k] = V::Load(sr + k * V::WIDTH);
+            vsi[k] = V::Load(si + k * V::WIDTH);
+            vsaveMark[k] = V::Load(saveMark + k * V::WIDTH);
+            vcount[k] = V::Load(count + k * V::WIDTH);
+        }
+
+        // Iterate until some lane escapes, reaches threshold or is found cyclic
+
+        for (bool anyFinished = false; anyFinished == false; )
+        {
+            for (int k = 0; k < UNROLL; ++k)
+            {
+                // z = z * z + c, with the products of the complex multiply kept separate
+                Reg zrzi = V::Mul(vzr[k], vzi[k]);
+                vzi[k] = V::Add(V::Add(zrzi, zrzi), vci[k]);
+                vzr[k] = V::Add(V::Sub(vzr2[k], vzi2[k]), vcr[k]);
+                vzr2[k] = V::Mul(vzr[k], vzr[k]);
+                vzi2[k] = V::Mul(vzi[k], vzi[k]);
+                vcount[k] = V::Add(vcount[k], vone);
+
+                Mask escaped = V::Greater(V::Add(vzr2[k], vzi2[k]), vfour);
+
+                // Back to where it was: cyclic, finished with a count past threshold
+                Mask near = V::AndNot(escaped, V::Greater(vtolerance, V::Abs(V::Sub(vzr[k], vsr[k]))));
+                if (V::Any(near))
+                {
+                    Mask cyclic = V::And(V::Greater(vtolerance, V::Abs(V::Sub(vzi[k], vsi[k]))), near);
+                    vcount[k] = V::Select(cyclic, vperiodic, vcount[k]);
+                }
+
+                Mask save = V::Greater(vcount[k], vsaveMark[k]);
+                vsr[k] = V::Select(save, vzr[k], vsr[k]);
+                vsi[k] = V::Select(save, vzi[k], vsi[k]);
+                vsaveMark[k] = V::Select(save, V::Add(V::Add(vsaveMark[k], vsaveMark[k]), vhalf), vsaveMark[k]);
+
+                Mask finished = V::Or(escaped, V::Greater(vcount[k], vlimit));
+                anyFinished |= V::Any(finished);
+            }
+        }
+
+        for (int k = 0; k < UNROLL; ++k)
+        {
+            V::Store(zr + k * V::WIDTH, vzr[k]);
+            V::Store(zi + k * V::WIDTH, vzi[k]);
+            V::Store(zr2 + k * V::WIDTH, vzr2[k]);
+            V::Store(zi2 + k * V::WIDTH, vzi2[k]);
+            V::Store(sr + k * V::WIDTH, vsr[k]);
+            V::Store(si + k * V::WIDTH, vsi[k]);
+            V::Store(saveMark + k * V::WIDTH, vsaveMark[k]);
+            V::Store(count + k * V::WIDTH, vcount[k]);
+        }
+
+        // Scatter results of finished lanes, and refill them
+        // The escape test is redone on stored values, with the same rounding
+
+        anyWorking = false;
+
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            if (texel[lane] >= 0)
+            {
+                const bool escaped = (zr2[lane] + zi2[lane] > four);
+
+                if (escaped || count[lane] >= args.threshold)
+                {
+                    // Escaping on iteration n (from 1) is stored as n - 1, like the scalar loop
+                    const Iteration_t result = escaped ? static_cast<Iteration_t>(count[lane] - 1) : args.threshold;
+
+                    if (escaped == false && count[lane] > args.threshold)
+                    {
+                        ++stats.periodicTexels;
+                    }
+
+                    args.iterations[texel[lane]] = result;
+
+                    if (escaped == false && args.orbits != nullptr)
+                    {
+                        if (count[lane] > args.threshold)
+                        {
+                            args.orbits->AddInside(texel[lane]);
+                        }
+                        else
+                        {
+                            args.orbits->Add(texel[lane], zr[lane], zi[lane], sr[lane], si[lane]);
+                        }
+                    }
+
+                    refill(lane);
+                }
+            }
+
+            anyWorking |= (texel[lane] >= 0);
+        }
+    }
+
+    return stats;
+}
+
+// Vectors from the precision, loop from the lane mode
+// Rows that don't split into whole lockstep groups take refill lanes, and so do orbits kept or carried on, and lists of texels
+template<typename V>
+static KernelStats ComputeWith(const KernelArgs& args, LaneMode mode)
+{
+    constexpr int UNROLL = 2;
+
+    if (mode == LaneMode::REFILL || args.width % (V::WIDTH * UNROLL) != 0 || args.orbits != nullptr || args.resume != nullptr || args.texels != nullptr)
+    {
+        return ComputeRefill<V, UNROLL>(args);
+    }
+    else
+    {
+        return ComputeLockstep<V, UNROLL>(args);
+    }
+}
+
+// The kernel of instruction set I, for every precision but those with kernels of their own, see RunKernel
+// Without MULTI, multi-double precisions are left to the scalar kernel
+template<typename I>
+static KernelStats ComputeVectorized(const KernelArgs& args, LaneMode mode)
+{
+    if (args.precision == Precision::FLOAT)
+    {
+        return ComputeWith<typename I::Float>(args, mode);
+    }
+    else if (args.precision == Precision::DOUBLE_DOUBLE || args.precision == Precision::QUAD_DOUBLE)
+    {
+        if constexpr (I::MULTI)
+        {
+            return (args.precision == Precision::DOUBLE_DOUBLE) ?
+                ComputeMulti<typename I::Double, 2>(args) :
+                ComputeMulti<typename I::Double, 4>(args);
+        }
+        else
+        {
+            return ComputeScalar(args, mode);
+        }
+    }
+    else
+    {
+        return ComputeWith<typename I::Double>(args, mode);
+    }
+}
+
+} // namespace
+} // namespace mdb
+
+#endif // !KERNEL_SIMD_H
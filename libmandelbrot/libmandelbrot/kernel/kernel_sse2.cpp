@@ -0,0 +1,100 @@
+#include <cmath>
+#include "kernel/kernel.h"
+
+#ifdef MDB_X86
+
+#include <immintrin.h>
+
+// Contraction turned off: a fused a * b + c rounds differently
+#if defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#pragma GCC target("sse2")
+#endif
+
+#include "kernel/kernel_simd.h"
+
+namespace mdb {
+
+// Local to this translation unit, see kernel_simd.h
+namespace {
+
+struct SSE2Double
+{
+    typedef double Scalar;
+    typedef __m128d Reg;
+    typedef __m128d Mask;     // All-ones lanes
+    constexpr static int WIDTH = 2;
+
+    static Reg Set1(Scalar x) { return _mm_set1_pd(x); }
+    static Reg Add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm_sub_pd(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm_mul_pd(a, b); }
+    static Reg Abs(Reg a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    static Mask Greater(Reg a, Reg b) { return _mm_cmpgt_pd(a, b); }
+    static Mask And(Mask a, Mask b) { return _mm_and_pd(a, b); }
+    static Mask AndNot(Mask a, Mask b) { return _mm_andnot_pd(a, b); }
+    static Mask Or(Mask a, Mask b) { return _mm_or_pd(a, b); }
+    static Reg Select(Mask mask, Reg a, Reg b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+    static bool Any(Mask mask) { return _mm_movemask_pd(mask) != 0; }
+    static int Count(Mask mask) { return PopCount(_mm_movemask_pd(mask)); }
+    static Reg Load(const Scalar* p) { return _mm_loadu_pd(p); }
+    static void Store(Scalar* p, Reg a) { _mm_storeu_pd(p, a); }
+};
+
+struct SSE2Float
+{
+    typedef float Scalar;
+    typedef __m128 Reg;
+    typedef __m128 Mask;      // All-ones lanes
+    constexpr static int WIDTH = 4;
+
+    static Reg Set1(Scalar x) { return _mm_set1_ps(x); }
+    static Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+    static Reg Abs(Reg a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static Mask Greater(Reg a, Reg b) { return _mm_cmpgt_ps(a, b); }
+    static Mask And(Mask a, Mask b) { return _mm_and_ps(a, b); }
+    static Mask AndNot(Mask a, Mask b) { return _mm_andnot_ps(a, b); }
+    static Mask Or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+    static Reg Select(Mask mask, Reg a, Reg b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+    static bool Any(Mask mask) { return _mm_movemask_ps(mask) != 0; }
+    static int Count(Mask mask) { return PopCount(_mm_movemask_ps(mask)); }
+    static Reg Load(const Scalar* p) { return _mm_loadu_ps(p); }
+    static void Store(Scalar* p, Reg a) { _mm_storeu_ps(p, a); }
+};
+
+// Instruction set, see ComputeVectorized
+struct SSE2
+{
+    typedef SSE2Double Double;
+    typedef SSE2Float Float;
+    constexpr static bool MULTI = false;    // No FMA for the exact products of multi-double precisions
+};
+
+} // namespace
+
+KernelStats ComputeSSE2(const KernelArgs& args, LaneMode mode)
+{
+    return ComputeVectorized<SSE2>(args, mode);
+}
+
+} // namespace mdb
+
+#if defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#else // !MDB_X86
+
+namespace mdb {
+
+KernelStats ComputeSSE2(const KernelArgs& args, LaneMode mode)
+{
+    return ComputeScalar(args, mode);
+}
+
+} // namespace mdb
+
+#endif // MDB_X86
@@ -8,8 +8,10 @@
 #define MDB_LOG_LEVEL_ERROR 4
 #define MDB_LOG_LEVEL_OFF   6
 
-// Set log level here
+// Set log level here, or on the command line
+#ifndef MDB_LOG_LEVEL
 #define MDB_LOG_LEVEL MDB_LOG_LEVEL_INFO
+#endif
 
 // Don't include anything if there is no logging
 
@@ -1,5 +1,9 @@
-#include <future>
-#include <thread>
+#include <memory>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <queue>
 #include <chrono>
 #include "map.h"
 #include "log.h"
@@ -66,6 +70,22 @@ constexpr Chunk_t floorModulo(Chunk_t dividend, Chunk_t modulo)
     }
 }
 
+// Does modulo and take the positive remainder
+// Corrects modulo for negative numbers
+// Assume positive modulo
+template<>
+constexpr int64_t floorModulo(int64_t dividend, int64_t modulo)
+{
+    if (dividend >= 0)
+    {
+        return dividend % modulo;
+    }
+    else
+    {
+        return (dividend + 1) % modulo + modulo - 1;
+    }
+}
+
 // Does modulo and take the positive remainder
 // Corrects modulo for negative numbers
 // Assume positive modulo
@@ -75,59 +95,275 @@ constexpr Number_t floorModulo(Number_t dividend, Number_t modulo)
     return dividend - floorDivide(dividend, modulo) * modulo;
 }
 
+// floor(offset / length), exactly, at any distance
+// Estimated in doubles, each estimate leaving a rest some 2^-50 the size, then corrected one by one
+static int64_t LatticeIndex(const Coordinate_t& offset, Number_t length)
+{
+    int64_t index = 0;
+    Coordinate_t rest = offset;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        index += static_cast<int64_t>(std::floor(rest.ToDouble() / length));
+        rest = offset - Coordinate_t::FromInteger(index) * length;
+    }
+
+    while (rest.IsNegative())
+    {
+        --index;
+        rest += length;
+    }
+    while ((rest - length).IsNegative() == false)
+    {
+        ++index;
+        rest -= length;
+    }
+
+    return index;
+}
+
+// Texels escaped below threshold
+// Iterations of those set in known, if given, summed apart too
+static EscapeTally Tally(const Chunk::Iterations_t& iterations, Iteration_t threshold, const std::vector<bool>* known, uint64_t& knownTotal) noexcept
+{
+    EscapeTally tally;
+    knownTotal = 0;
+
+    for (int index = 0; index < Chunk::SIZE * Chunk::SIZE; ++index)
+    {
+        const Iteration_t iteration = iterations[index];
+        if (iteration >= threshold)
+        {
+            continue;
+        }
+
+        tally.iterations += iteration;
+        tally.late += (iteration >= threshold / 2);
+        tally.earlier += (iteration >= threshold / 4 && iteration < threshold / 2);
+        if (known != nullptr && (*known)[index])
+        {
+            knownTotal += iteration;
+        }
+    }
+
+    return tally;
+}
+
+// Iterations of texels a chunk tallied up to from would find escaping up to to, see EscapeTally
+// Within a doubling, spread evenly in log scale: those escaping from start up to end add up to count * (end - start) / ln 2
+static Number_t Extrapolate(const EscapeTally& tally, Iteration_t from, Iteration_t to) noexcept
+{
+    if (from == 0 || to <= from)
+    {
+        return 0;
+    }
+
+    const Number_t ratio = (tally.earlier == 0) ? 1 : std::fmin(1, static_cast<Number_t>(tally.late) / tally.earlier);
+    Number_t count = tally.late;
+    Number_t total = 0;
+    for (Number_t start = from; start < to; start *= 2)
+    {
+        count *= ratio;
+        total += count * (std::fmin(start * 2, to) - start) / std::log(2.0);
+    }
+    return total;
+}
+
 /***************************************************************
     Class
 ***************************************************************/
 
 void BufferChunks::debugPrint()
 {
-    MDB_TRACE("Number (x, y): ({}, {})", x, y);
+    MDB_TRACE("Lattice (cx, cy): ({}, {})", cx, cy);
     MDB_TRACE(
         "Chunks: from ({}, {}) inclusive, to ({}, {}) exclusive",
         u, v, u + uSize, v + vSize
     );
 }
 
-std::atomic<int> Map::nowComputing{ 0 };
-
 Map::~Map()
 {
     MDB_INFO("Waiting for computations to end...");
 
-    using namespace std::chrono_literals;
-    constexpr auto WAIT_TIME = 10ms;
+    // Jobs refer to chunks owned by this Map
+    Supersede();
+    pool.Wait();
+}
 
-    while (nowComputing.load() != 0)
+void Map::Supersede()
+{
+    for (Chunk_t vMod = 0; vMod < vSize; ++vMod)
     {
-        std::this_thread::sleep_for(WAIT_TIME);
+        for (Chunk_t uMod = 0; uMod < uSize; ++uMod)
+        {
+            // Finished ones too, unless already taken
+            ChunkRecord& record = chunksRecord[vMod][uMod];
+            if (record.job != nullptr)
+            {
+                record.job->cancelled.store(true);
+            }
+            Mark(uMod, vMod);
+        }
     }
 }
 
+void Map::Mark(Chunk_t uMod, Chunk_t vMod)
+{
+    ChunkRecord& record = chunksRecord[vMod][uMod];
+    if (record.shouldCompute == false)
+    {
+        record.shouldCompute = true;
+        marked.push_back({ uMod, vMod });
+    }
+}
+
+bool Map::InBuffer(Chunk_t uMod, Chunk_t vMod) const noexcept
+{
+    return
+        floorModulo(static_cast<Chunk_t>(uMod - buffer.u), uSize) < buffer.uSize &&
+        floorModulo(static_cast<Chunk_t>(vMod - buffer.v), vSize) < buffer.vSize;
+}
+
+void Map::Recompute()
+{
+    Supersede();
+
+    // Or the chunks would come back from the cache, or from their own slot
+    for (std::vector<ChunkRecord>& row : chunksRecord)
+    {
+        for (ChunkRecord& record : row)
+        {
+            record.complete = false;
+        }
+    }
+    cache.Clear();
+    previousLattices.clear();
+}
+
+bool Map::Settled() const noexcept
+{
+    if (marked.empty() == false)
+    {
+        return false;
+    }
+
+    for (Chunk_t vMod = 0; vMod < vSize; ++vMod)
+    {
+        for (Chunk_t uMod = 0; uMod < uSize; ++uMod)
+        {
+            if (InBuffer(uMod, vMod) == false)
+            {
+                continue;
+            }
+
+            uint32_t generation;
+            const ChunkState::Phase phase = chunksState[vMod][uMod].Load(generation);
+            const ChunkRecord& record = chunksRecord[vMod][uMod];
+            const bool inFlight = (phase == ChunkState::Phase::QUEUED || phase == ChunkState::Phase::COMPUTING || phase == ChunkState::Phase::READY);
+
+            if (inFlight || record.complete == false || record.shouldCompute || record.drawnThreshold != lastThreshold)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Map::ChangeTexelLength(Number_t texelLength)
+{
+    // Halved or doubled at least, however close texelLength is
+    if (snapping)
+    {
+        const Number_t steps = std::log2(texelLength / this->texelLength);
+        const int exponent = (steps < 0) ?
+            std::min(-1, static_cast<int>(std::ceil(steps))) :
+            std::max(1, static_cast<int>(std::floor(steps)));
+        texelLength = std::ldexp(this->texelLength, exponent);
+    }
+
+    if (anchored)
+    {
+        // Slots in flight are dropped, the rest handed to the cache, where previews find them
+        for (Chunk_t vMod = 0; vMod < vSize; ++vMod)
+        {
+            for (Chunk_t uMod = 0; uMod < uSize; ++uMod)
+            {
+                ChunkRecord& record = chunksRecord[vMod][uMod];
+                if (record.complete)
+                {
+                    cache.Store(record.key, chunks[vMod][uMod]);
+                }
+                record.complete = false;
+            }
+        }
+
+        previousLattices.insert(previousLattices.begin(), { level, anchorX, anchorY, this->texelLength });
+        if (previousLattices.size() > PREVIEW_LEVELS)
+        {
+            previousLattices.pop_back();
+        }
+    }
+
+    this->texelLength = texelLength;
+    this->chunkLength = texelLength * Chunk::SIZE;
+    ++level;
+    anchored = false;
+    Supersede();
+}
+
 void Map::UpdateBuffer(NumberRange range)
 {
     buffer.debugPrint();
 
+    view = range;
+
     // Calculate new buffer based on current buffer and most recent range
 
+    // A new lattice is anchored at the view, so keys stay small at any zoom
+    if (anchored == false)
+    {
+        anchorX = range.x;
+        anchorY = range.y;
+
+        // On a texel of the previous lattice, and of the coarser of the two laid from there, so every level shares texels
+        if (snapping && previousLattices.empty() == false)
+        {
+            const Lattice& previous = previousLattices.front();
+            const Number_t coarser = std::fmax(texelLength, previous.texelLength);
+            anchorX = previous.anchorX + Coordinate_t::FromInteger(LatticeIndex(range.x - previous.anchorX, coarser)) * coarser;
+            anchorY = previous.anchorY - Coordinate_t::FromInteger(LatticeIndex(previous.anchorY - range.y, coarser)) * coarser;
+        }
+
+        anchored = true;
+    }
+
     BufferChunks newBuffer;
 
-    // Using floating point to avoid overflow, accepting floating point error
-    // Check overflow later when storing value back in Chunk_t
-    Number_t chunkDu = floorDivide(range.x - buffer.x, chunkLength);
-    Number_t chunkDv = floorDivide(buffer.y - range.y, chunkLength);
-    //ILOG("Chunk Difference: (" <<
-    //    chunkDu << ", " <<
-    //    chunkDv << ")");
+    // Exact: panning any distance lands on the same keys for the same place
+    newBuffer.cx = LatticeIndex(range.x - anchorX, chunkLength);
+    newBuffer.cy = LatticeIndex(anchorY - range.y, chunkLength);
 
-    newBuffer.x = buffer.x + chunkDu * chunkLength;
-    newBuffer.y = buffer.y - chunkDv * chunkLength;
+    // Within a chunk of its top-left one, so doubles from here on
+    const Number_t offsetX = (range.x - ChunkX(newBuffer.cx)).ToDouble();
+    const Number_t offsetY = (ChunkY(newBuffer.cy) - range.y).ToDouble();
 
-    newBuffer.uSize = 1 + floorDivide(range.x + range.width - newBuffer.x, chunkLength);
-    newBuffer.vSize = 1 + floorDivide(newBuffer.y - (range.y - range.height), chunkLength);
+    newBuffer.uSize = 1 + floorDivide(offsetX + range.width, chunkLength);
+    newBuffer.vSize = 1 + floorDivide(offsetY + range.height, chunkLength);
     //ILOG("Chunk wh: (" <<
     //    newBuffer.uSize << ", " <<
     //    newBuffer.vSize << ")");
 
+    const int64_t chunkDu = newBuffer.cx - buffer.cx;
+    const int64_t chunkDv = newBuffer.cy - buffer.cy;
+
+    // Chunks may have left it, see UpdateState
+    if (chunkDu != 0 || chunkDv != 0 || newBuffer.uSize != buffer.uSize || newBuffer.vSize != buffer.vSize)
+    {
+        bufferMoved = true;
+    }
+
     // If u or v is more than uSize or vSize off, then all chunks need re-computing
     // No need to check individual chunks then
     // Also, prevents new u, v from overflowing Chunk_t
@@ -141,16 +377,16 @@ void Map::UpdateBuffer(NumberRange range)
 
         // Fitting new u, v to old buffer
 
-        Chunk_t chunkDuMod = floorModulo(chunkDu, static_cast<Number_t>(uSize));
-        Chunk_t chunkDvMod = floorModulo(chunkDv, static_cast<Number_t>(vSize));
+        Chunk_t chunkDuMod = static_cast<Chunk_t>(floorModulo(chunkDu, static_cast<int64_t>(uSize)));
+        Chunk_t chunkDvMod = static_cast<Chunk_t>(floorModulo(chunkDv, static_cast<int64_t>(vSize)));
 
         buffer.u = floorModulo(static_cast<Chunk_t>(buffer.u + chunkDuMod), uSize);
         buffer.v = floorModulo(static_cast<Chunk_t>(buffer.v + chunkDvMod), vSize);
 
         // Other fields can just be copied
 
-        buffer.x = newBuffer.x;
-        buffer.y = newBuffer.y;
+        buffer.cx = newBuffer.cx;
+        buffer.cy = newBuffer.cy;
 
         buffer.uSize = newBuffer.uSize;
         buffer.vSize = newBuffer.vSize;
@@ -170,7 +406,7 @@ void Map::UpdateBuffer(NumberRange range)
                     u, v, uMod, vMod
                 );
 
-                chunksStatus[vMod][uMod] |= Chunk::SHOULD_COMPUTE_BIT;
+                Mark(uMod, vMod);
             }
         }
     }
@@ -181,8 +417,8 @@ void Map::UpdateBuffer(NumberRange range)
         // Modulo later when copying data back to buffer
         // Non-modulo value needed to check bounds
 
-        newBuffer.u = buffer.u + chunkDu;
-        newBuffer.v = buffer.v + chunkDv;
+        newBuffer.u = static_cast<Chunk_t>(buffer.u + chunkDu);
+        newBuffer.v = static_cast<Chunk_t>(buffer.v + chunkDv);
 
         // Check chunks in new bound (newBuffer), if they need to be re-computed
 
@@ -205,7 +441,7 @@ void Map::UpdateBuffer(NumberRange range)
                         u, v, uMod, vMod
                     );
 
-                    chunksStatus[vMod][uMod] |= Chunk::SHOULD_COMPUTE_BIT;
+                    Mark(uMod, vMod);
                 }
             }
         }
@@ -213,8 +449,8 @@ void Map::UpdateBuffer(NumberRange range)
         // Storing data of new buffer, doing floorModulo() to u, v
         // And ditching old buffer
 
-        buffer.x = newBuffer.x;
-        buffer.y = newBuffer.y;
+        buffer.cx = newBuffer.cx;
+        buffer.cy = newBuffer.cy;
         buffer.u = floorModulo(newBuffer.u, uSize);
         buffer.v = floorModulo(newBuffer.v, vSize);
         buffer.uSize = newBuffer.uSize;
@@ -224,12 +460,103 @@ void Map::UpdateBuffer(NumberRange range)
     buffer.debugPrint();
 }
 
-static std::vector<std::future<void>> futures;
+const char* DispatchOrderName(DispatchOrder order) noexcept
+{
+    switch (order)
+    {
+    case DispatchOrder::NEAREST_FIRST: return "nearest first";
+    case DispatchOrder::LONGEST_FIRST: return "longest first";
+    }
+    return "unknown";
+}
 
-void Map::UpdateState(std::unique_ptr<Texture>& texture, Iteration_t threshold)
+const char* CostSourceName(CostSource source) noexcept
 {
-    bool hasDrawn = false;
+    switch (source)
+    {
+    case CostSource::RAISE: return "raise";
+    case CostSource::SAME_CHUNK: return "same chunk";
+    case CostSource::OTHER_LEVEL: return "other level";
+    case CostSource::NEIGHBOURS: return "neighbours";
+    case CostSource::AVERAGE: return "average";
+    }
+    return "unknown";
+}
+
+const char* TierReasonName(TierReason reason) noexcept
+{
+    switch (reason)
+    {
+    case TierReason::INITIAL: return "initial";
+    case TierReason::FITS: return "fits";
+    case TierReason::TOO_CLOSE: return "texels too close";
+    case TierReason::CHEAPER_FITS: return "cheaper precision fits";
+    case TierReason::HYSTERESIS: return "held by hysteresis";
+    case TierReason::SETTING: return "precision setting";
+    }
+    return "unknown";
+}
+
+void Map::UpdateTier()
+{
+    // Corners of the buffer
+    const Number_t left = ChunkX(buffer.cx).ToDouble();
+    const Number_t top = ChunkY(buffer.cy).ToDouble();
+    const Number_t magnitude = std::fmax(
+        std::fmax(std::fabs(left), std::fabs(left + buffer.uSize * chunkLength)),
+        std::fmax(std::fabs(top), std::fabs(top - buffer.vSize * chunkLength))
+    );
+
+    // Enum order is the order of precision
+    const Precision fits = Chunk::SelectPrecision(magnitude, texelLength, floatPrecision, deepPrecision);
+    const Precision cheap = Chunk::SelectPrecision(magnitude, texelLength / TIER_HYSTERESIS, floatPrecision, deepPrecision);
+
+    PrecisionTier next = tier;
+    next.texelLength = texelLength;
+    next.magnitude = magnitude;
+
+    if (tier.reason == TierReason::INITIAL)
+    {
+        next.precision = fits;
+        next.reason = TierReason::FITS;
+    }
+    else if (deepPrecision != tierDeepPrecision || floatPrecision != tierFloatPrecision)
+    {
+        next.precision = fits;
+        next.reason = TierReason::SETTING;
+    }
+    else if (fits > tier.precision)
+    {
+        next.precision = fits;
+        next.reason = TierReason::TOO_CLOSE;
+    }
+    else if (cheap < tier.precision)
+    {
+        next.precision = cheap;
+        next.reason = TierReason::CHEAPER_FITS;
+    }
+    else if (fits < tier.precision)
+    {
+        next.reason = TierReason::HYSTERESIS;
+    }
+    else if (tier.reason == TierReason::HYSTERESIS)
+    {
+        next.reason = TierReason::FITS;
+    }
+
+    const bool changed = next.precision != tier.precision;
+    tier = next;
+    tierDeepPrecision = deepPrecision;
+    tierFloatPrecision = floatPrecision;
+
+    if (changed == false)
+    {
+        return;
+    }
 
+    MDB_INFO("Precision tier {} ({}) at texel length {}", PrecisionName(tier.precision), TierReasonName(tier.reason), texelLength);
+
+    // Chunks waiting to be computed take the new tier anyway
     for (Chunk_t v = buffer.v; v < buffer.v + buffer.vSize; ++v)
     {
         for (Chunk_t u = buffer.u; u < buffer.u + buffer.uSize; ++u)
@@ -237,79 +564,860 @@ void Map::UpdateState(std::unique_ptr<Texture>& texture, Iteration_t threshold)
             // floorModulo not needed: stays positive and within +1 modulo
             Chunk_t uMod = u % uSize;
             Chunk_t vMod = v % vSize;
-            Chunk::Status_t& status = chunksStatus[vMod][uMod];
-            Chunk& chunk = chunks[vMod][uMod];
 
-            if (status & Chunk::SHOULD_COMPUTE_BIT)
+            if (chunks[vMod][uMod].GetPrecision() != tier.precision)
             {
-                //ILOG("Chunk: (" << uMod << ", " << vMod << ")");
+                Mark(uMod, vMod);
+            }
+        }
+    }
+}
 
-                // Atomic, but there are no synchronization or ordering constraints
-                // ++nowComputing
-                nowComputing.fetch_add(1, std::memory_order_relaxed);
+void Map::UpdateReference(Iteration_t threshold)
+{
+    if (tier.precision != Precision::PERTURBATION)
+    {
+        reference.reset();
+        return;
+    }
+
+    const Coordinate_t centerX = ChunkX(buffer.cx) + buffer.uSize * chunkLength / 2;
+    const Coordinate_t centerY = ChunkY(buffer.cy) - buffer.vSize * chunkLength / 2;
+
+    if (reference != nullptr && reference->Threshold() == threshold)
+    {
+        // Deltas stay within a buffer or so of the reference
+        const Number_t dx = (centerX - reference->X()).ToDouble();
+        const Number_t dy = (centerY - reference->Y()).ToDouble();
+        if (std::fabs(dx) < buffer.uSize * chunkLength && std::fabs(dy) < buffer.vSize * chunkLength)
+        {
+            return;
+        }
+    }
 
-                status &= ~Chunk::SHOULD_COMPUTE_BIT;
+    reference = std::make_shared<const ReferenceOrbit>(centerX, centerY, threshold);
+    MDB_INFO("New reference orbit at texel length {}, {} iterations long", texelLength, reference->Length());
+}
 
-                auto compute = [&status, &chunk, this, u, v] (Iteration_t threshold)
+bool Map::Aligned(const Lattice& lattice) const
+{
+    // Powers of two apart, exactly
+    int exponent;
+    if (std::frexp(lattice.texelLength / texelLength, &exponent) != static_cast<Number_t>(0.5))
+    {
+        return false;
+    }
+
+    const Number_t finer = std::fmin(texelLength, lattice.texelLength);
+    auto onFiner = [finer](const Coordinate_t& offset)
+    {
+        return (offset - Coordinate_t::FromInteger(LatticeIndex(offset, finer)) * finer).IsZero();
+    };
+
+    return onFiner(anchorX - lattice.anchorX) && onFiner(lattice.anchorY - anchorY);
+}
+
+int Map::Preview(Chunk_t u, Chunk_t v, Iteration_t threshold, std::vector<bool>& known)
+{
+    // How many times finer or coarser, in powers of two
+    auto distance = [this](const Lattice* lattice)
+    {
+        return std::fabs(std::log2(lattice->texelLength / texelLength));
+    };
+
+    std::vector<const Lattice*> lattices;
+    for (const Lattice& lattice : previousLattices)
+    {
+        if (distance(&lattice) <= std::log2(PREVIEW_RATIO) || lattice.texelLength > texelLength)
+        {
+            lattices.push_back(&lattice);
+        }
+    }
+    std::stable_sort(lattices.begin(), lattices.end(), [&distance](const Lattice* a, const Lattice* b) { return distance(a) < distance(b); });
+
+    const ChunkKey key = KeyAt(u, v);
+    const Coordinate_t originX = ChunkX(key.cx);
+    const Coordinate_t originY = ChunkY(key.cy);
+
+    std::vector<bool>& filled = previewCovered;
+    filled.assign(Chunk::SIZE * Chunk::SIZE, false);
+    int filledCount = 0;
+    known.assign(Chunk::SIZE * Chunk::SIZE, false);
+    int knownCount = 0;
+
+    for (const Lattice* lattice : lattices)
+    {
+        const Number_t sourceChunkLength = lattice->texelLength * Chunk::SIZE;
+
+        // Chunk of the lattice holding the top-left texel, and where in it, within a chunk so doubles from here on
+        const Coordinate_t offsetX = originX - lattice->anchorX;
+        const Coordinate_t offsetY = lattice->anchorY - originY;
+        const int64_t cx = LatticeIndex(offsetX, sourceChunkLength);
+        const int64_t cy = LatticeIndex(offsetY, sourceChunkLength);
+        const Number_t restX = (offsetX - Coordinate_t::FromInteger(cx) * sourceChunkLength).ToDouble();
+        const Number_t restY = (offsetY - Coordinate_t::FromInteger(cy) * sourceChunkLength).ToDouble();
+
+        // Chunks of the lattice this one overlaps, looked up once
+        const int64_t span = 2 + static_cast<int64_t>(chunkLength / sourceChunkLength);
+        std::vector<const Chunk::Iterations_t*> sources(span * span);
+        std::vector<Precision> sourcePrecisions(span * span);
+        std::vector<Iteration_t> sourceThresholds(span * span);
+        bool anySource = false;
+        for (int64_t j = 0; j < span; ++j)
+        {
+            for (int64_t i = 0; i < span; ++i)
+            {
+                const int64_t at = i + j * span;
+                sources[at] = cache.Peek({ lattice->level, cx + i, cy + j }, sourcePrecisions[at], sourceThresholds[at]);
+                anySource |= (sources[at] != nullptr);
+            }
+        }
+        if (anySource == false)
+        {
+            continue;
+        }
+
+        // Texel of the lattice nearest to each texel of the chunk, counted from the top-left one of chunk (cx, cy),
+        // and whether it is the same point, which PERTURBATION iterates from a reference it may not have shared
+        std::array<int64_t, Chunk::SIZE> columns;
+        std::array<int64_t, Chunk::SIZE> rows;
+        std::array<bool, Chunk::SIZE> exactColumns = {};
+        std::array<bool, Chunk::SIZE> exactRows = {};
+        const bool aligned = Aligned(*lattice) && tier.precision != Precision::PERTURBATION;
+
+        if (aligned)
+        {
+            // Exactly, in texels of the finer lattice
+            const Number_t finer = std::fmin(texelLength, lattice->texelLength);
+            const int64_t step = std::llround(texelLength / finer);
+            const int64_t sourceStep = std::llround(lattice->texelLength / finer);
+            const int64_t offsetU = std::llround(restX / finer);
+            const int64_t offsetV = std::llround(restY / finer);
+
+            for (int texel = 0; texel < Chunk::SIZE; ++texel)
+            {
+                const int64_t column = offsetU + texel * step;
+                const int64_t row = offsetV + texel * step;
+                columns[texel] = (column + sourceStep / 2) / sourceStep;
+                rows[texel] = (row + sourceStep / 2) / sourceStep;
+                exactColumns[texel] = (column % sourceStep == 0);
+                exactRows[texel] = (row % sourceStep == 0);
+            }
+        }
+        else
+        {
+            for (int texel = 0; texel < Chunk::SIZE; ++texel)
+            {
+                columns[texel] = static_cast<int64_t>(std::floor((restX + texel * texelLength) / lattice->texelLength + 0.5));
+                rows[texel] = static_cast<int64_t>(std::floor((restY + texel * texelLength) / lattice->texelLength + 0.5));
+            }
+        }
+
+        // Chunk of the lattice, and texel within it
+        std::array<int64_t, Chunk::SIZE> chunkColumns;
+        std::array<int, Chunk::SIZE> texelColumns;
+        for (int texel = 0; texel < Chunk::SIZE; ++texel)
+        {
+            chunkColumns[texel] = columns[texel] / Chunk::SIZE;
+            texelColumns[texel] = static_cast<int>(columns[texel] % Chunk::SIZE);
+        }
+
+        // Of texels at the same point, those the kernels start from the same bits as they did for the lattice, iterated alike then
+        // Origins of chunks apart round apart, so offsets from them may not meet again
+        auto startAlike = [this, lattice](bool row, const Coordinate_t& origin, const std::array<int64_t, Chunk::SIZE>& indices,
+            auto sourceOrigin, std::array<bool, Chunk::SIZE>& exact)
+        {
+            Number_t head;
+            Number_t tail[3];
+            Chunk::SplitCoordinate(origin, head, tail);
+
+            int64_t split = -1;     // Chunk of the lattice split into sourceHead and sourceTail
+            Number_t sourceHead = 0;
+            Number_t sourceTail[3] = {};
+            for (int texel = 0; texel < Chunk::SIZE; ++texel)
+            {
+                if (exact[texel] == false)
                 {
-                    chunk.Compute
-                    (
-                        buffer.x + (u - buffer.u) * chunkLength,
-                        buffer.y - (v - buffer.v) * chunkLength,
-                        texelLength,
-                        threshold
-                    );
+                    continue;
+                }
 
-                    status |= Chunk::SHOULD_DRAW_BIT;
+                const int64_t chunk = indices[texel] / Chunk::SIZE;
+                if (chunk != split)
+                {
+                    Chunk::SplitCoordinate(sourceOrigin(chunk), sourceHead, sourceTail);
+                    split = chunk;
+                }
+
+                const int sourceTexel = static_cast<int>(indices[texel] % Chunk::SIZE);
+                exact[texel] = StartOf(tier.precision, head, tail, texelLength, texel, row) ==
+                    StartOf(tier.precision, sourceHead, sourceTail, lattice->texelLength, sourceTexel, row);
+            }
+        };
 
-                    // Atomic, but there are no synchronization or ordering constraints
-                    // --nowComputing
-                    nowComputing.fetch_sub(1, std::memory_order_relaxed);
-                };
+        if (aligned)
+        {
+            startAlike(true, originX, columns,
+                [&](int64_t i) { return lattice->anchorX + Coordinate_t::FromInteger(cx + i) * sourceChunkLength; }, exactColumns);
+            startAlike(false, originY, rows,
+                [&](int64_t j) { return lattice->anchorY - Coordinate_t::FromInteger(cy + j) * sourceChunkLength; }, exactRows);
+        }
 
-                futures.push_back
-                (
-                    std::async(std::launch::async, compute, threshold)
-                );
+        for (int texelV = 0; texelV < Chunk::SIZE; ++texelV)
+        {
+            const int64_t j = rows[texelV] / Chunk::SIZE;
+            const int sourceRow = static_cast<int>(rows[texelV] % Chunk::SIZE) * Chunk::SIZE;
+            if (j >= span)
+            {
+                continue;
             }
-            else if (status & Chunk::SHOULD_DRAW_BIT)
+
+            for (int texelU = 0; texelU < Chunk::SIZE; ++texelU)
             {
-                status &= ~Chunk::SHOULD_DRAW_BIT;
+                const int index = texelU + texelV * Chunk::SIZE;
+                const int64_t i = chunkColumns[texelU];
+                const int64_t at = i + j * span;
+                if (i >= span || sources[at] == nullptr || known[index])
+                {
+                    continue;
+                }
+
+                const Iteration_t iteration = (*sources[at])[texelColumns[texelU] + sourceRow];
+                const bool bounded = (iteration >= sourceThresholds[at]);
+
+                // Started alike in the same precision, escaped or bounded up to threshold at least, so the same value up to threshold
+                const bool exact =
+                    exactColumns[texelU] && exactRows[texelV] && sourcePrecisions[at] == tier.precision &&
+                    (bounded == false || sourceThresholds[at] >= threshold);
 
-                if (hasDrawn == false)
+                if (exact)
                 {
+                    known[index] = true;
+                    ++knownCount;
+                }
+                else if (filled[index])
+                {
+                    continue;
+                }
+
+                // Bounded up to its threshold, drawn as bounded up to this one
+                (*preview)[index] = bounded ? threshold : std::min(iteration, threshold);
+                if (filled[index] == false)
+                {
+                    filled[index] = true;
+                    ++filledCount;
+                }
+            }
+        }
+
+        if (knownCount == Chunk::SIZE * Chunk::SIZE)
+        {
+            break;
+        }
+    }
+
+    if (knownCount == 0)
+    {
+        known.clear();
+    }
+
+    if (filledCount == 0)
+    {
+        return 0;
+    }
+
+    // Of count entries, those not covered copied from the nearest covered one, the earlier on ties; false if none is covered
+    auto fillGaps = [](int count, auto covered, auto copy)
+    {
+        int previous = -1;
+        for (int at = 0; at < count; ++at)
+        {
+            if (covered(at) == false)
+            {
+                continue;
+            }
+            for (int gap = previous + 1; gap < at; ++gap)
+            {
+                copy(gap, (previous >= 0 && gap - previous <= at - gap) ? previous : at);
+            }
+            previous = at;
+        }
+        if (previous < 0)
+        {
+            return false;
+        }
+        for (int gap = previous + 1; gap < count; ++gap)
+        {
+            copy(gap, previous);
+        }
+        return true;
+    };
+
+    // Texels none covers take the nearest covered one of their row, rows without any the nearest row with some,
+    // so nothing the slot held before is drawn; they aren't known, so they are computed all the same
+    if (filledCount < Chunk::SIZE * Chunk::SIZE)
+    {
+        std::array<bool, Chunk::SIZE> coveredRows;
+        for (int texelV = 0; texelV < Chunk::SIZE; ++texelV)
+        {
+            const int row = texelV * Chunk::SIZE;
+            coveredRows[texelV] = fillGaps(Chunk::SIZE,
+                [&filled, row](int texelU) { return filled[row + texelU]; },
+                [this, row](int to, int from) { (*preview)[row + to] = (*preview)[row + from]; });
+        }
+
+        fillGaps(Chunk::SIZE,
+            [&coveredRows](int texelV) { return coveredRows[texelV]; },
+            [this](int to, int from) { std::copy_n(preview->begin() + from * Chunk::SIZE, Chunk::SIZE, preview->begin() + to * Chunk::SIZE); });
+    }
+
+    // floorModulo not needed: stays positive and within +1 modulo
+    Chunk& chunk = chunks[v % vSize][u % uSize];
+    chunk.Load(*preview, threshold, chunk.GetPrecision());
+    return filledCount;
+}
+
+CostPrediction Map::PredictCost(Chunk_t u, Chunk_t v, Iteration_t threshold, int covered, const std::vector<bool>& known) const
+{
+    constexpr int TEXELS = Chunk::SIZE * Chunk::SIZE;
+
+    const int knownCount = static_cast<int>(std::count(known.begin(), known.end(), true));
+    const Number_t share = static_cast<Number_t>(TEXELS - knownCount) / TEXELS;
+    auto computed = [&known](int index) { return known.empty() || known[index] == false; };
+
+    CostPrediction prediction;
+
+    // Beyond the threshold it was computed up to, extrapolated
+    Precision sourcePrecision;
+    Iteration_t sourceThreshold;
+    const ChunkKey key = KeyAt(u, v);
+    if (const Chunk::Iterations_t* same = cache.Peek(key, sourcePrecision, sourceThreshold))
+    {
+        const Iteration_t below = std::min(threshold, sourceThreshold);
+        uint64_t knownTotal;
+        const EscapeTally tally = Tally(*same, below, known.empty() ? nullptr : &known, knownTotal);
+        prediction.iterations = static_cast<Number_t>(tally.iterations - knownTotal) + Extrapolate(tally, below, threshold) * share;
+        prediction.source = CostSource::SAME_CHUNK;
+        return prediction;
+    }
+
+    // Known texels are covered, the others no level covers taken as the average of those covered
+    if (covered > knownCount)
+    {
+        Number_t sum = 0;
+        for (int index = 0; index < TEXELS; ++index)
+        {
+            if (computed(index) && previewCovered[index] && (*preview)[index] < threshold)
+            {
+                sum += (*preview)[index];
+            }
+        }
+        prediction.iterations = sum * (TEXELS - knownCount) / (covered - knownCount);
+        prediction.source = CostSource::OTHER_LEVEL;
+        return prediction;
+    }
+
+    // Complete chunks of the buffer around it, extrapolated to this threshold, nearer ones weighing more
+    Number_t sum = 0;
+    Number_t weights = 0;
+    for (Chunk_t neighbourV = static_cast<Chunk_t>(v - NEIGHBOUR_REACH); neighbourV <= v + NEIGHBOUR_REACH; ++neighbourV)
+    {
+        for (Chunk_t neighbourU = static_cast<Chunk_t>(u - NEIGHBOUR_REACH); neighbourU <= u + NEIGHBOUR_REACH; ++neighbourU)
+        {
+            const bool inBuffer =
+                neighbourU >= buffer.u && neighbourU < buffer.u + buffer.uSize &&
+                neighbourV >= buffer.v && neighbourV < buffer.v + buffer.vSize;
+            if (inBuffer == false || (neighbourU == u && neighbourV == v))
+            {
+                continue;
+            }
+
+            // floorModulo not needed: stays positive and within +1 modulo
+            const ChunkRecord& record = chunksRecord[neighbourV % vSize][neighbourU % uSize];
+            if (record.complete == false || record.key != KeyAt(neighbourU, neighbourV))
+            {
+                continue;
+            }
+
+            const Iteration_t from = chunks[neighbourV % vSize][neighbourU % uSize].Threshold();
+            const Number_t weight = 1 / std::hypot(neighbourU - u, neighbourV - v);
+            sum += weight * (record.escapes.iterations + Extrapolate(record.escapes, from, threshold));
+            weights += weight;
+        }
+    }
+
+    if (weights > 0)
+    {
+        prediction.iterations = sum / weights * share;
+        prediction.source = CostSource::NEIGHBOURS;
+        return prediction;
+    }
+
+    prediction.iterations = averageCost * share;
+    prediction.source = CostSource::AVERAGE;
+    return prediction;
+}
+
+void Map::SetFocus(const Coordinate_t& x, const Coordinate_t& y)
+{
+    focusX = x;
+    focusY = y;
+    focused = true;
+}
+
+DispatchPriority Map::PriorityOf(Chunk_t u, Chunk_t v, const CostPrediction& cost) const
+{
+    const ChunkKey key = KeyAt(u, v);
+    const Coordinate_t left = ChunkX(key.cx);
+    const Coordinate_t top = ChunkY(key.cy);
+
+    DispatchPriority priority;
+
+    // Right of and below its top-left corner, within a chunk or so of it, so doubles from here on
+    const Number_t viewX = (view.x - left).ToDouble();
+    const Number_t viewY = (top - view.y).ToDouble();
+    priority.visible =
+        viewX < chunkLength && viewX + view.width > 0 &&
+        viewY < chunkLength && viewY + view.height > 0;
+
+    Number_t focusU = viewX + view.width / 2;
+    Number_t focusV = viewY + view.height / 2;
+    if (focused)
+    {
+        focusU = (focusX - left).ToDouble();
+        focusV = (top - focusY).ToDouble();
+    }
+
+    const Number_t du = std::fmax(std::fmax(-focusU, focusU - chunkLength), 0);
+    const Number_t dv = std::fmax(std::fmax(-focusV, focusV - chunkLength), 0);
+    priority.distance = std::hypot(du, dv);
+
+    if (order == DispatchOrder::LONGEST_FIRST)
+    {
+        priority.cost = cost.iterations;
+    }
+
+    return priority;
+}
+
+void Map::Dispatch(Chunk_t u, Chunk_t v, Iteration_t threshold, bool raise, const CostPrediction& cost, std::shared_ptr<const std::vector<bool>> known)
+{
+    // floorModulo not needed: stays positive and within +1 modulo
+    Chunk_t uMod = u % uSize;
+    Chunk_t vMod = v % vSize;
+    ChunkState& state = chunksState[vMod][uMod];
+    Chunk& chunk = chunks[vMod][uMod];
+
+    // Positions at full precision here, from the key, the worker rounds them to the precision
+    const ChunkKey key = KeyAt(u, v);
+    const Coordinate_t originX = ChunkX(key.cx);
+    const Coordinate_t originY = ChunkY(key.cy);
+
+    const Precision precision = tier.precision;
+    const std::shared_ptr<const ReferenceOrbit> chunkReference = reference;
+    const Iteration_t from = chunk.Threshold();
+    const auto job = std::make_shared<ChunkJob>();
+    job->raise = raise;
+    job->predicted = cost;
+    job->baseline = raise ? chunksRecord[vMod][uMod].escapes.iterations : 0;
+    chunk.SetPrecision(precision);
+    chunk.SetThreshold(threshold);
+    chunk.SetOrbitMemory(orbitMemory / (buffer.uSize * buffer.vSize));
+    chunk.SetCancel(&job->cancelled);
+    job->generation = state.Queue();
+    chunksRecord[vMod][uMod].shouldCompute = false;
+    chunksRecord[vMod][uMod].complete = false;
+    chunksRecord[vMod][uMod].key = key;
+    chunksRecord[vMod][uMod].job = job;
+
+    // Runs on a worker, splitting the chunk into tiles on that worker's deque
+    // Idle workers steal tiles, so expensive chunks don't form the tail
+    // Everything taken by value: the Map may have moved to another texel length by then
+    auto compute = [&state, &chunk, this, u, v, uMod, vMod, originX, originY, texelLength = this->texelLength, from, threshold, precision, chunkReference, raise, known, job, strategy = this->strategy] ()
+    {
+        MDB_TRACE("Chunk ({}, {}) {} in {}, {}, generation {}", u, v, raise ? "raised" : "computed", PrecisionName(precision), Chunk::StrategyName(strategy), job->generation);
+
+        state.Move(job->generation, ChunkState::Phase::QUEUED, ChunkState::Phase::COMPUTING);
+
+        for (int tile = 0; tile < Chunk::TILE_COUNT; ++tile)
+        {
+            pool.Submit([&state, &chunk, this, u, v, uMod, vMod, originX, originY, texelLength, from, threshold, precision, strategy, chunkReference, raise, known, tile, job] ()
+            {
+                const auto start = std::chrono::steady_clock::now();
+
+                if (raise)
+                {
+                    chunk.Raise(originX, originY, texelLength, from, threshold, precision, chunkReference.get(), tile);
+                }
+                else
+                {
+                    chunk.Compute(originX, originY, texelLength, threshold, precision, strategy, chunkReference.get(), tile, known.get());
+                }
+
+                const auto spent = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                job->nanoseconds.fetch_add(spent.count(), std::memory_order_relaxed);
+
+                // Last tile to finish hands the chunk over for drawing, or throws it away if superseded
+                // Acquires what the other tiles wrote, to be released by the move
+                // Queued after the move, so UpdateState finds the chunk moved on when it drains the queue
+                if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    if (job->cancelled.load())
+                    {
+                        state.Move(job->generation, ChunkState::Phase::COMPUTING, ChunkState::Phase::IDLE);
+                    }
+                    else
+                    {
+                        MDB_TRACE(
+                            "Chunk ({}, {}) skipped {} interior texels, {} found periodic, {} filled, {} glitched, {} reused",
+                            u, v, chunk.Stats().skippedTexels, chunk.Stats().periodicTexels, chunk.Stats().filledTexels,
+                            chunk.Stats().glitchedTexels, chunk.Stats().reusedTexels
+                        );
+
+                        // Off the thread calling UpdateState, for predicting the cost of chunks after it
+                        uint64_t knownTotal;
+                        job->escapes = Tally(chunk.Iterations(), threshold, known.get(), knownTotal);
+                        job->baseline += knownTotal;
+
+                        state.Move(job->generation, ChunkState::Phase::COMPUTING, ChunkState::Phase::READY);
+                    }
+                    completions.Push({ { uMod, vMod }, job->generation });
+                }
+            });
+        }
+    };
+
+    pool.Submit(compute);
+}
+
+bool Map::Take(Chunk_t uMod, Chunk_t vMod, uint32_t generation)
+{
+    ChunkRecord& record = chunksRecord[vMod][uMod];
+    chunksState[vMod][uMod].Move(generation, ChunkState::Phase::READY, ChunkState::Phase::DRAWN);
+    record.complete = (record.job->cancelled.load() == false);
+    if (record.complete == false)
+    {
+        return false;
+    }
+
+    const ChunkJob& job = *record.job;
+    record.escapes = job.escapes;
+
+    const Number_t actual = static_cast<Number_t>(job.escapes.iterations) - static_cast<Number_t>(job.baseline);
+    const Number_t seconds = static_cast<Number_t>(job.nanoseconds.load()) * 1e-9;
+    DispatchCost& cost = costStats.bySource[static_cast<size_t>(job.predicted.source)];
+    ++cost.chunks;
+    cost.predicted += job.predicted.iterations;
+    cost.actual += actual;
+    cost.absoluteError += std::fabs(job.predicted.iterations - actual);
+    cost.seconds += seconds;
+
+    MDB_TRACE(
+        "Chunk ({}, {}) predicted {} iterations from {}, added {} in {} s",
+        uMod, vMod, job.predicted.iterations, CostSourceName(job.predicted.source), actual, seconds
+    );
+
+    // Recent chunks weigh most: the view moves on
+    if (job.raise == false)
+    {
+        const Number_t iterations = static_cast<Number_t>(job.escapes.iterations);
+        averageCost = (averageCost == 0) ? iterations : averageCost + (iterations - averageCost) / AVERAGE_COST_WINDOW;
+    }
+
+    return true;
+}
+
+void Map::UpdateState(std::unique_ptr<Texture>& texture, Iteration_t threshold)
+{
+    bool hasDrawn = false;
+
+    UpdateTier();
+    UpdateReference(threshold);
+
+    // Submitted after the walk, in priority order: the pool starts chunks in the order they come
+    struct Pending
+    {
+        DispatchPriority priority;
+        Chunk_t u;
+        Chunk_t v;
+        bool raise;
+        CostPrediction cost;
+        std::shared_ptr<const std::vector<bool>> known;
+
+        bool operator<(const Pending& other) const noexcept { return priority < other.priority; }
+    };
+    std::priority_queue<Pending> pending;
+
+    // Slot back to where a walk of the buffer from buffer.u, buffer.v finds it
+    auto unwrap = [](Chunk_t mod, Chunk_t start, Chunk_t size)
+    {
+        return static_cast<Chunk_t>(start + floorModulo(static_cast<Chunk_t>(mod - start), size));
+    };
+
+    auto raiseCost = [threshold](const ChunkRecord& record, const Chunk& chunk)
+    {
+        return CostPrediction{ Extrapolate(record.escapes, chunk.Threshold(), threshold), CostSource::RAISE };
+    };
+
+    // A new threshold concerns every chunk at rest, the others are seen to when they finish or are walked
+    if (threshold != lastThreshold)
+    {
+        for (Chunk_t v = buffer.v; v < buffer.v + buffer.vSize; ++v)
+        {
+            for (Chunk_t u = buffer.u; u < buffer.u + buffer.uSize; ++u)
+            {
+                // floorModulo not needed: stays positive and within +1 modulo
+                Chunk_t uMod = u % uSize;
+                Chunk_t vMod = v % vSize;
+                ChunkRecord& record = chunksRecord[vMod][uMod];
+                Chunk& chunk = chunks[vMod][uMod];
+
+                uint32_t generation;
+                const ChunkState::Phase phase = chunksState[vMod][uMod].Load(generation);
+                if (record.shouldCompute || phase == ChunkState::Phase::QUEUED || phase == ChunkState::Phase::COMPUTING || phase == ChunkState::Phase::READY)
+                {
+                    continue;
+                }
+
+                if (threshold > chunk.Threshold())
+                {
+                    // Only texels bounded at the old threshold are iterated again
+                    const CostPrediction cost = raiseCost(record, chunk);
+                    pending.push({ PriorityOf(u, v, cost), u, v, true, cost, nullptr });
+                }
+                else if (threshold != record.drawnThreshold)
+                {
+                    // Iterations below threshold are exact, the others bounded either way
+                    record.drawnThreshold = threshold;
                     hasDrawn = true;
+                    chunk.Draw(texture, uMod, vMod, threshold);
                 }
+            }
+        }
+
+        lastThreshold = threshold;
+    }
+
+    // Chunks finished since the last call, those marked are left to the walk below
+    finished.clear();
+    completions.Drain(finished);
+
+    for (const ChunkCompletion& completion : finished)
+    {
+        const Chunk_t uMod = completion.slot.uMod;
+        const Chunk_t vMod = completion.slot.vMod;
+        ChunkState& state = chunksState[vMod][uMod];
+        ChunkRecord& record = chunksRecord[vMod][uMod];
+        Chunk& chunk = chunks[vMod][uMod];
+
+        // Dispatched again since
+        uint32_t generation;
+        const ChunkState::Phase phase = state.Load(generation);
+        if (generation != completion.generation)
+        {
+            continue;
+        }
+
+        if (InBuffer(uMod, vMod) == false)
+        {
+            // Finished out of the buffer: not worth drawing, but kept for the cache
+            if (phase == ChunkState::Phase::READY)
+            {
+                Take(uMod, vMod, generation);
+            }
+
+            // Computed anew when back in the buffer, so its orbits are of no use
+            chunk.DropOrbits();
+            continue;
+        }
+
+        if (record.shouldCompute || phase != ChunkState::Phase::READY)
+        {
+            continue;
+        }
+
+        // Superseded after its last tile returned
+        if (Take(uMod, vMod, generation) == false)
+        {
+            Mark(uMod, vMod);
+            continue;
+        }
+
+        record.drawnThreshold = threshold;
+        hasDrawn = true;
+        chunk.Draw(texture, uMod, vMod, threshold);
+
+        // Threshold went up while it was in flight
+        if (threshold > chunk.Threshold())
+        {
+            const Chunk_t u = unwrap(uMod, buffer.u, uSize);
+            const Chunk_t v = unwrap(vMod, buffer.v, vSize);
+            const CostPrediction cost = raiseCost(record, chunk);
+            pending.push({ PriorityOf(u, v, cost), u, v, true, cost, nullptr });
+        }
+    }
 
+    // Chunks marked for computing, kept listed while a cancelled dispatch of theirs is in flight
+    size_t kept = 0;
+    for (const ChunkSlot slot : marked)
+    {
+        const Chunk_t uMod = slot.uMod;
+        const Chunk_t vMod = slot.vMod;
+        ChunkState& state = chunksState[vMod][uMod];
+        ChunkRecord& record = chunksRecord[vMod][uMod];
+        Chunk& chunk = chunks[vMod][uMod];
+
+        // Marked again by UpdateBuffer when back in
+        if (InBuffer(uMod, vMod) == false)
+        {
+            record.shouldCompute = false;
+            continue;
+        }
+
+        const Chunk_t u = unwrap(uMod, buffer.u, uSize);
+        const Chunk_t v = unwrap(vMod, buffer.v, vSize);
+        const ChunkKey key = KeyAt(u, v);
+
+        uint32_t generation;
+        const ChunkState::Phase phase = state.Load(generation);
+
+        if (phase == ChunkState::Phase::QUEUED || phase == ChunkState::Phase::COMPUTING)
+        {
+            // For the same chunk, not superseded: left to finish
+            if (record.job->cancelled.load() == false && record.key == key && chunk.GetPrecision() == tier.precision)
+            {
+                record.shouldCompute = false;
+                continue;
+            }
+
+            // Its tiles stop within a row, and the slot waits for the last of them to move it on,
+            // so none writes over what comes next
+            record.job->cancelled.store(true);
+            marked[kept++] = slot;
+            continue;
+        }
+
+        // Finished meanwhile, it is as good as any complete chunk, unless cancelled first
+        if (phase == ChunkState::Phase::READY)
+        {
+            Take(uMod, vMod, generation);
+        }
+
+        record.shouldCompute = false;
+
+        bool reused = false;
+        if (record.complete)
+        {
+            // Back in the buffer before its slot was taken
+            if (record.key == key && chunk.GetPrecision() == tier.precision)
+            {
+                reused = true;
+            }
+            else
+            {
+                cache.Store(record.key, chunk);
+            }
+        }
+
+        if (reused == false && cache.Load(key, tier.precision, chunk))
+        {
+            record.complete = true;
+            record.key = key;
+            reused = true;
+
+            uint64_t knownTotal;
+            record.escapes = Tally(chunk.Iterations(), chunk.Threshold(), nullptr, knownTotal);
+        }
+
+        if (reused)
+        {
+            record.drawnThreshold = threshold;
+            hasDrawn = true;
+            chunk.Draw(texture, uMod, vMod, threshold);
+
+            // Computed up to a lower threshold
+            if (threshold > chunk.Threshold())
+            {
+                const CostPrediction cost = raiseCost(record, chunk);
+                pending.push({ PriorityOf(u, v, cost), u, v, true, cost, nullptr });
+            }
+        }
+        else
+        {
+            // Shown scaled from another level meanwhile, replaced in place when computed
+            // Texels another level holds exactly are kept
+            auto known = std::make_shared<std::vector<bool>>();
+            const int covered = Preview(u, v, threshold, *known);
+            hasDrawn = true;
+            if (covered > 0)
+            {
                 chunk.Draw(texture, uMod, vMod, threshold);
             }
+            else
+            {
+                Chunk::DrawPending(texture, uMod, vMod);
+            }
+
+            const CostPrediction cost = PredictCost(u, v, threshold, covered, *known);
+            pending.push({ PriorityOf(u, v, cost), u, v, false, cost, known->empty() ? nullptr : std::move(known) });
         }
     }
+    marked.resize(kept);
 
-    if (hasDrawn)
+    while (pending.empty() == false)
     {
-        texture->Update();
+        const Pending& next = pending.top();
+        Dispatch(next.u, next.v, threshold, next.raise, next.cost, next.known);
+        pending.pop();
+    }
+
+    // Chunks out of the buffer are computed anew when back in, so their orbits are of no use
+    // Those still in flight drop theirs when they finish, see above
+    if (bufferMoved)
+    {
+        for (Chunk_t vMod = 0; vMod < vSize; ++vMod)
+        {
+            for (Chunk_t uMod = 0; uMod < uSize; ++uMod)
+            {
+                if (InBuffer(uMod, vMod))
+                {
+                    continue;
+                }
+
+                // Finished out of the buffer: not worth drawing, but kept for the cache
+                uint32_t generation;
+                const ChunkState::Phase phase = chunksState[vMod][uMod].Load(generation);
+                if (phase == ChunkState::Phase::READY)
+                {
+                    Take(uMod, vMod, generation);
+                }
+
+                if (phase != ChunkState::Phase::QUEUED && phase != ChunkState::Phase::COMPUTING)
+                {
+                    chunks[vMod][uMod].DropOrbits();
+                }
+            }
+        }
+
+        bufferMoved = false;
     }
 
-    if (nowComputing.load() == 0)
+    if (hasDrawn)
     {
-        futures.clear();
+        texture->Update();
     }
 }
 
 void Map::Draw(std::unique_ptr<Texture>& source, NumberRange range, Number_t pixelLength)
 {
-    Number_t x = Right();
-    Number_t y = Bottom();
-    MDB_TRACE("Border: ({}, {})", x, y);
+    MDB_TRACE("Border: ({}, {})", Right().ToDouble(), Bottom().ToDouble());
 
     Number_t texelPerPixel = texelLength / pixelLength;
 
     // Can go beyond border of texture
     // floorModulo not needed: stays positive and within +1 modulo
     RectI src = {
-            (buffer.u * Chunk::SIZE + (int)((range.x - buffer.x) / texelLength)) % (uSize * Chunk::SIZE),
-            (buffer.v * Chunk::SIZE - (int)((range.y - buffer.y) / texelLength)) % (vSize * Chunk::SIZE),
+            (buffer.u * Chunk::SIZE + (int)((range.x - ChunkX(buffer.cx)).ToDouble() / texelLength)) % (uSize * Chunk::SIZE),
+            (buffer.v * Chunk::SIZE - (int)((range.y - ChunkY(buffer.cy)).ToDouble() / texelLength)) % (vSize * Chunk::SIZE),
             range.width / pixelLength,
             range.height / pixelLength
     };
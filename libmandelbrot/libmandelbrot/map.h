@@ -2,19 +2,25 @@
 #define MAP_H
 
 #include <vector>
+#include <array>
 #include <atomic>
+#include <memory>
 #include "common.h"
 #include "graphics.h"
 #include "chunk.h"
+#include "chunk_cache.h"
+#include "reference_orbit.h"
+#include "thread_pool.h"
+#include "mpsc_queue.h"
 
 namespace mdb {
 
 // The smallest set of chunks that encompasses the screen
 struct BufferChunks
 {
-    Number_t x = 0;
-    Number_t y = 0;
-    Chunk_t u = 0;
+    int64_t cx = 0;     // Lattice position of the top-left chunk
+    int64_t cy = 0;
+    Chunk_t u = 0;      // Its place in the circular buffer
     Chunk_t v = 0;
     Chunk_t uSize = 0;
     Chunk_t vSize = 0;
@@ -25,20 +31,261 @@ struct BufferChunks
 // Visible number range
 struct NumberRange
 {
-    Number_t x = 0;
-    Number_t y = 0;
+    Coordinate_t x;
+    Coordinate_t y;
     Number_t width = 0;
     Number_t height = 0;
 };
 
+// Why the view has its precision
+enum class TierReason
+{
+    INITIAL,        // Nothing computed yet
+    FITS,           // Cheapest precision that resolves neighbouring texels
+    TOO_CLOSE,      // Texels got too close for the previous precision, zoomed in or moved away from 0
+    CHEAPER_FITS,   // A cheaper precision resolves texels again, by TIER_HYSTERESIS
+    HYSTERESIS,     // A cheaper precision would resolve texels, but not by TIER_HYSTERESIS, so the previous one is kept
+    SETTING         // The float or deep precision setting changed
+};
+
+[[nodiscard]] const char* TierReasonName(TierReason reason) noexcept;
+
+// Precision chunks of the view are computed in, and what decided it
+struct PrecisionTier
+{
+    Precision precision = Precision::DOUBLE;
+    TierReason reason = TierReason::INITIAL;
+    Number_t texelLength = 0;   // When decided
+    Number_t magnitude = 0;     // Largest coordinate of the buffer, when decided
+};
+
+// Where the chunk of a slot is between the thread calling Map::UpdateState and the tiles computing it,
+// with the generation of its last dispatch, in one atomic word so neither side takes a lock
+// Moved on by compare-and-swap, each side from the phases it owns: tiles from QUEUED and COMPUTING, UpdateState from the others
+// Tiles of an earlier dispatch compare an older generation, so they can't move a slot dispatched again
+class ChunkState
+{
+public:
+
+    enum class Phase : uint32_t
+    {
+        IDLE,       // Nothing dispatched, or thrown away
+        QUEUED,     // Dispatched, no tile started yet
+        COMPUTING,  // Some tile started
+        READY,      // Every tile returned, not taken by UpdateState yet
+        DRAWN       // Taken by UpdateState: drawn, or kept for the cache if out of the buffer
+    };
+
+    ChunkState() = default;
+
+    // For filling the Map, before any tile runs
+    ChunkState(const ChunkState& other) noexcept :
+        word(other.word.load()) {}
+
+    [[nodiscard]] Phase Load(uint32_t& generation) const noexcept
+    {
+        const uint32_t value = word.load(std::memory_order_acquire);
+        generation = value >> PHASE_BITS;
+        return static_cast<Phase>(value & PHASE_MASK);
+    }
+
+    // False if the slot was not at from in generation
+    // Acquires what the other side wrote before its last move, releases what this one wrote before this one
+    bool Move(uint32_t generation, Phase from, Phase to) noexcept
+    {
+        uint32_t expected = Pack(generation, from);
+        return word.compare_exchange_strong(expected, Pack(generation, to), std::memory_order_acq_rel);
+    }
+
+    // To QUEUED in the next generation, which is returned
+    // From a phase UpdateState owns only: no tile of an earlier dispatch is left to race with
+    uint32_t Queue() noexcept
+    {
+        const uint32_t generation = (word.load(std::memory_order_relaxed) >> PHASE_BITS) + 1;
+        word.store(Pack(generation, Phase::QUEUED), std::memory_order_release);
+        return generation & (~0u >> PHASE_BITS);
+    }
+
+private:
+
+    constexpr static uint32_t PHASE_BITS = 3;
+    constexpr static uint32_t PHASE_MASK = (1u << PHASE_BITS) - 1;
+
+    // Generations wrap around, only ever compared for equality
+    [[nodiscard]] constexpr static uint32_t Pack(uint32_t generation, Phase phase) noexcept
+    {
+        return (generation << PHASE_BITS) | static_cast<uint32_t>(phase);
+    }
+
+    std::atomic<uint32_t> word{ 0 };
+};
+
+// Order chunks are dispatched in, visible ones before the others either way
+// Idle workers steal tiles before taking another chunk, see ThreadPool, so the tail is a tile long in either
+enum class DispatchOrder
+{
+    NEAREST_FIRST,  // Nearest to the focus
+    LONGEST_FIRST   // Most iterations predicted, see CostPrediction; nearest first among equal ones
+};
+
+[[nodiscard]] const char* DispatchOrderName(DispatchOrder order) noexcept;
+
+// What a predicted cost is taken from, tried in this order
+enum class CostSource
+{
+    RAISE,          // Texels of the chunk that escaped late, see EscapeTally
+    SAME_CHUNK,     // The chunk cached at another threshold or precision
+    OTHER_LEVEL,    // Texels of other levels scaled over it, see Map::Preview
+    NEIGHBOURS,     // Complete chunks around it
+    AVERAGE         // Chunks computed so far, 0 before any
+};
+
+constexpr int COST_SOURCE_COUNT = 5;
+
+[[nodiscard]] const char* CostSourceName(CostSource source) noexcept;
+
+// Iterations of texels a dispatch is expected to find escaping, texels set in known not counted
+// Bounded texels are left out: interior checks, periodicity and filling make most of them cheap, so they predict time worse than nothing
+struct CostPrediction
+{
+    Number_t iterations = 0;
+    CostSource source = CostSource::AVERAGE;
+};
+
+// Texels of a chunk escaped below its threshold
+// The counts of the last two doublings before it tell how many a higher threshold would find escaping,
+// each doubling taken to find as many times fewer as the last one did
+struct EscapeTally
+{
+    uint64_t iterations = 0;    // Summed
+    uint32_t late = 0;          // Escaped from half the threshold on
+    uint32_t earlier = 0;       // From a quarter of it to half of it
+};
+
+// Predicted against actual cost of finished dispatches
+struct DispatchCost
+{
+    uint64_t chunks = 0;
+    Number_t predicted = 0;         // Iterations, see CostPrediction
+    Number_t actual = 0;            // Iterations of texels the chunks found escaping
+    Number_t absoluteError = 0;     // Of each chunk, summed
+    Number_t seconds = 0;           // Spent in their tiles
+
+    [[nodiscard]] Number_t RelativeError() const noexcept
+    {
+        return (actual == 0) ? 0 : absoluteError / actual;
+    }
+
+    DispatchCost& operator+=(const DispatchCost& other) noexcept
+    {
+        chunks += other.chunks;
+        predicted += other.predicted;
+        actual += other.actual;
+        absoluteError += other.absoluteError;
+        seconds += other.seconds;
+        return *this;
+    }
+};
+
+struct DispatchCostStats
+{
+    std::array<DispatchCost, COST_SOURCE_COUNT> bySource;   // Indexed by CostSource
+
+    [[nodiscard]] DispatchCost Total() const noexcept
+    {
+        DispatchCost total;
+        for (const DispatchCost& cost : bySource)
+        {
+            total += cost;
+        }
+        return total;
+    }
+};
+
+// Shared by the tiles of one dispatch and the record of its slot
+struct ChunkJob
+{
+    uint32_t generation = 0;                            // See ChunkState
+    std::atomic<bool> cancelled{ false };               // Superseded: tiles stop within a row, the result is thrown away
+    std::atomic<int> remaining{ Chunk::TILE_COUNT };    // Tiles not returned yet, writing to the chunk
+    std::atomic<int64_t> nanoseconds{ 0 };              // Spent in tiles so far
+
+    bool raise = false;
+    CostPrediction predicted;
+
+    // Set by the last tile before the chunk is READY, see ChunkRecord
+    EscapeTally escapes;
+    uint64_t baseline = 0;      // Iterations of texels the chunk held escaped before or was given as known, not found by the dispatch
+};
+
+// Place of a chunk in the ring, taken modulo
+struct ChunkSlot
+{
+    Chunk_t uMod = 0;
+    Chunk_t vMod = 0;
+};
+
+// Pushed by the last tile of a dispatch, whether the chunk is ready or thrown away
+struct ChunkCompletion
+{
+    ChunkSlot slot;
+    uint32_t generation = 0;    // See ChunkState
+};
+
+// What the texture shows of a chunk, kept by the thread calling Map::UpdateState only
+struct ChunkRecord
+{
+    bool shouldCompute = false;         // For the key at its place, as soon as no tile is in flight; see Map::Mark
+    bool complete = false;              // Holds the finished result for key
+    Iteration_t drawnThreshold = 0;     // Threshold it was last drawn with
+    ChunkKey key;                       // What it holds, or is being computed for
+    std::shared_ptr<ChunkJob> job;      // Last dispatched
+
+    EscapeTally escapes;                // Of the complete result
+};
+
+// Where the chunks of a level are, kept after leaving it to preview the chunks of later levels
+struct Lattice
+{
+    int64_t level = 0;
+    Coordinate_t anchorX;
+    Coordinate_t anchorY;
+    Number_t texelLength = 0;
+};
+
+// Order chunks are dispatched in, the greater first
+struct DispatchPriority
+{
+    bool visible = false;   // Within the range, so on screen
+    Number_t cost = 0;      // Predicted iterations, with DispatchOrder::LONGEST_FIRST only
+    Number_t distance = 0;  // From the focus to the nearest point of the chunk
+
+    friend bool operator<(const DispatchPriority& a, const DispatchPriority& b) noexcept
+    {
+        if (a.visible != b.visible)
+        {
+            return b.visible;
+        }
+        if (a.cost != b.cost)
+        {
+            return a.cost < b.cost;
+        }
+        return a.distance > b.distance;
+    }
+};
+
 // 2D circular buffer for iteration data, consisting of Chunks and their states
 class Map
 {
 public:
 
-    Map(Number_t texelLength, Chunk_t uSize, Chunk_t vSize) :
+    // Computation is submitted to pool, which must outlive the Map
+    Map(ThreadPool& pool, Number_t texelLength, Chunk_t uSize, Chunk_t vSize) :
+        pool(pool),
         chunks(std::vector<std::vector<Chunk>>(vSize, std::vector<Chunk>(uSize))),
-        chunksStatus(std::vector<std::vector<Chunk::Status_t>>(vSize, std::vector<Chunk::Status_t>(uSize, Chunk::INIT))),
+        chunksState(std::vector<std::vector<ChunkState>>(vSize, std::vector<ChunkState>(uSize))),
+        chunksRecord(std::vector<std::vector<ChunkRecord>>(vSize, std::vector<ChunkRecord>(uSize))),
+        preview(std::make_unique<Chunk::Iterations_t>()),
         texelLength(texelLength),
         chunkLength(texelLength * Chunk::SIZE),
         uSize(uSize),
@@ -53,15 +300,69 @@ public:
     // Stateful, based on current buffer aside from given range
     void UpdateBuffer(NumberRange range);
 
-    // Dispatches work
+    // Dispatches work, chunks visible in the range last given to UpdateBuffer first, then as SetDispatchOrder says
+    // A lower threshold than chunks were computed with only redraws them, a higher one iterates their bounded texels further
+    // Visits chunks that finished, were marked for computing or left the buffer since the last call, and every chunk only when the threshold changes
     void UpdateState(std::unique_ptr<Texture>& texture, Iteration_t threshold);
 
+    // Where chunks are computed from, outwards, until ClearFocus; the center of the range otherwise
+    // Among chunks of equal predicted cost only with DispatchOrder::LONGEST_FIRST
+    void SetFocus(const Coordinate_t& x, const Coordinate_t& y);
+    void ClearFocus() noexcept { focused = false; }
+
     void Draw(std::unique_ptr<Texture>& source, NumberRange range, Number_t pixelLength);
 
-    void Recompute()
-    {
-        chunksStatus = std::vector<std::vector<Chunk::Status_t>>(vSize, std::vector<Chunk::Status_t>(uSize, Chunk::INIT));
-    }
+    // Chunks in flight are cancelled, see ChunkJob
+    // Cached chunks are dropped too, and with them previews from other levels
+    void Recompute();
+
+    // Every chunk of the buffer computed and drawn with the threshold of the last UpdateState, none in flight or left to dispatch
+    // Until then, UpdateState has more to do
+    [[nodiscard]] bool Settled() const noexcept;
+
+    // Used from the next UpdateState
+    void SetDispatchOrder(DispatchOrder order) noexcept { this->order = order; }
+    [[nodiscard]] DispatchOrder GetDispatchOrder() const noexcept { return order; }
+
+    // Cost predicted for each chunk dispatched against what it took, by what the prediction was taken from
+    // Kept in either DispatchOrder
+    [[nodiscard]] const DispatchCostStats& CostStats() const noexcept { return costStats; }
+
+    // Used by chunks computed afterwards; brute force by default, subdivision fills a few texels wrong, see test_subdivide
+    void SetStrategy(Chunk::Strategy strategy) noexcept { this->strategy = strategy; }
+    [[nodiscard]] Chunk::Strategy GetStrategy() const noexcept { return strategy; }
+
+    // Float where texels are far enough apart, see Chunk::SelectPrecision
+    // Off by default: at the default view, about 0.1% of texels escape at another iteration than in double
+    // Chunks are computed again where the tier changes because of it
+    void SetFloatPrecision(bool allowed) noexcept { floatPrecision = allowed; }
+    [[nodiscard]] bool GetFloatPrecision() const noexcept { return floatPrecision; }
+
+    // Past double: DOUBLE_DOUBLE, FIXED_POINT, QUAD_DOUBLE or PERTURBATION, see Chunk::SelectPrecision
+    // Chunks are computed again where the tier changes because of it
+    void SetDeepPrecision(Precision precision) noexcept { deepPrecision = precision; }
+    [[nodiscard]] Precision GetDeepPrecision() const noexcept { return deepPrecision; }
+
+    // Bytes the chunks of the buffer may keep orbits in, shared evenly, 0 for none; see Chunk::SetOrbitMemory
+    // Used by chunks computed afterwards; chunks out of the buffer drop theirs
+    void SetOrbitMemory(size_t bytes) noexcept { orbitMemory = bytes; }
+    [[nodiscard]] size_t GetOrbitMemory() const noexcept { return orbitMemory; }
+
+    constexpr static size_t DEFAULT_ORBIT_MEMORY = 64 * 1024 * 1024;
+
+    // Bytes for chunks that left the ring, looked up before computing any chunk; see ChunkCache
+    void SetCacheMemory(size_t bytes) { cache.SetMemory(bytes); }
+    [[nodiscard]] size_t GetCacheMemory() const noexcept { return cache.GetMemory(); }
+    [[nodiscard]] const ChunkCacheStats& CacheStats() const noexcept { return cache.Stats(); }
+
+    constexpr static size_t DEFAULT_CACHE_MEMORY = 64 * 1024 * 1024;
+
+    // Chosen for the view on each UpdateState, before dispatching
+    [[nodiscard]] const PrecisionTier& Tier() const noexcept { return tier; }
+
+    // Moving to a cheaper precision waits until it resolves texels this many times closer than they are
+    // Zooming back and forth around a boundary then doesn't recompute the view each time
+    constexpr static Number_t TIER_HYSTERESIS = 2;
 
     /***************************************************************
         texelLength
@@ -69,12 +370,23 @@ public:
 
     [[nodiscard]] constexpr Number_t TexelLength() const noexcept { return texelLength; }
 
-    void ChangeTexelLength(Number_t texelLength)
-    {
-        this->texelLength = texelLength;
-        this->chunkLength = texelLength * Chunk::SIZE;
-        Recompute();
-    }
+    // Starts a new lattice, anchored by the next UpdateBuffer
+    // Finished chunks of the current one are cached, and scaled to preview chunks of the new one until they are computed
+    // Those in flight are cancelled
+    // Snapped to the current length times a power of two if set, see SetSnapping
+    void ChangeTexelLength(Number_t texelLength);
+
+    // Texel lengths then change by powers of two, rounded towards the current one, and lattices are laid over each other
+    // Texels a cached level holds are then copied into chunks of the new one, rather than computed
+    // Scene stays within a halved or doubled length while MaxPixelLength is at least twice MinPixelLength
+    void SetSnapping(bool snapping) noexcept { this->snapping = snapping; }
+    [[nodiscard]] bool GetSnapping() const noexcept { return snapping; }
+
+    // Levels previews are taken from, most recent first
+    // Of those, lattices more than PREVIEW_RATIO times finer or coarser are skipped, scaling them costs more than it shows,
+    // but for coarser ones filling texels no nearer one covers, as they look up a few chunks only
+    constexpr static int PREVIEW_LEVELS = 4;
+    constexpr static Number_t PREVIEW_RATIO = 16;
 
     constexpr static Number_t MIN_TEXEL_PER_PIXEL = 1;
 
@@ -120,27 +432,115 @@ private:
         Utility
     ***************************************************************/
 
+    // Top-left corner of chunks at lattice position cx, or cy, exact from the key
+    [[nodiscard]] Coordinate_t ChunkX(int64_t cx) const noexcept
+    {
+        return anchorX + Coordinate_t::FromInteger(cx) * chunkLength;
+    }
+
+    [[nodiscard]] Coordinate_t ChunkY(int64_t cy) const noexcept
+    {
+        return anchorY - Coordinate_t::FromInteger(cy) * chunkLength;
+    }
+
+    // Of the chunk at (u, v) of the buffer, from its top-left one, u and v not taken modulo
+    [[nodiscard]] ChunkKey KeyAt(Chunk_t u, Chunk_t v) const noexcept
+    {
+        return { level, buffer.cx + (u - buffer.u), buffer.cy + (v - buffer.v) };
+    }
+
     // Return the represented number value on the right border
-    [[nodiscard]] constexpr Number_t Right() const noexcept
+    [[nodiscard]] Coordinate_t Right() const noexcept
     {
-        return buffer.x + (uSize - buffer.u) * chunkLength;
+        return ChunkX(buffer.cx + (uSize - buffer.u));
     }
 
     // Return the represented number value on the bottom border
-    [[nodiscard]] constexpr Number_t Bottom() const noexcept
+    [[nodiscard]] Coordinate_t Bottom() const noexcept
     {
-        return buffer.y - (vSize - buffer.v) * chunkLength;
+        return ChunkY(buffer.cy + (vSize - buffer.v));
     }
 
+    // Every chunk marked for computing again, those in flight or not taken yet cancelled
+    void Supersede();
+
+    // Listed for the next UpdateState to compute, once
+    void Mark(Chunk_t uMod, Chunk_t vMod);
+
+    // Whether the slot holds a chunk of the buffer
+    [[nodiscard]] bool InBuffer(Chunk_t uMod, Chunk_t vMod) const noexcept;
+
+    // Chunks computed in another precision are marked for computing again
+    void UpdateTier();
+
+    // Kept while the tier is PERTURBATION, near the buffer and at the same threshold
+    void UpdateReference(Iteration_t threshold);
+
+    // Whether texels of lattice and of the current one are the same points, where the finer one has a texel
+    [[nodiscard]] bool Aligned(const Lattice& lattice) const;
+
+    // Fills the chunk at (u, v) with the nearest texels of chunks cached for previous levels, nearest texel length first
+    // Texels none covers are left out of previewCovered and take the value of the nearest covered one; returns how many some level covers,
+    // 0 if none, the chunk then left as it was
+    // Those an aligned level computed in the precision of the tier, from the same bits as its kernels start from here, see StartOf,
+    // are set in known, left empty if none
+    int Preview(Chunk_t u, Chunk_t v, Iteration_t threshold, std::vector<bool>& known);
+
+    // Of computing the chunk at (u, v) but for texels set in known, after Preview covered as many
+    // From the first of CostSource that has something to go by
+    [[nodiscard]] CostPrediction PredictCost(Chunk_t u, Chunk_t v, Iteration_t threshold, int covered, const std::vector<bool>& known) const;
+
+    // Where the chunk at (u, v) comes in dispatch order, see UpdateState
+    [[nodiscard]] DispatchPriority PriorityOf(Chunk_t u, Chunk_t v, const CostPrediction& cost) const;
+
+    // Submits the tiles of the chunk at (u, v), computed whole but for texels set in known, or raised from the threshold it holds if raise is set
+    void Dispatch(Chunk_t u, Chunk_t v, Iteration_t threshold, bool raise, const CostPrediction& cost, std::shared_ptr<const std::vector<bool>> known = nullptr);
+
+    // READY to DRAWN, complete unless cancelled, its cost then counted in costStats
+    bool Take(Chunk_t uMod, Chunk_t vMod, uint32_t generation);
+
+    ThreadPool& pool;
     std::vector<std::vector<Chunk>> chunks;
-    std::vector<std::vector<Chunk::Status_t>> chunksStatus;
+    std::vector<std::vector<ChunkState>> chunksState;   // Never reallocated: tiles in flight hold on to theirs
+    std::vector<std::vector<ChunkRecord>> chunksRecord;
+    MpscQueue<ChunkCompletion> completions;     // Pushed by workers, drained by UpdateState
+    std::vector<ChunkCompletion> finished;      // Drained into, kept for its capacity
+    std::vector<ChunkSlot> marked;              // Those with shouldCompute set
+    Iteration_t lastThreshold = 0;              // Of the last UpdateState
+    bool bufferMoved = false;                   // Since the last UpdateState
     BufferChunks buffer;
+    NumberRange view;       // Last given to UpdateBuffer
+    Coordinate_t focusX;
+    Coordinate_t focusY;
+    bool focused = false;
+    int64_t level = 0;
+    Coordinate_t anchorX;   // Of the lattice of level
+    Coordinate_t anchorY;
+    bool anchored = false;
+    bool snapping = false;
+    std::vector<Lattice> previousLattices;  // Most recent first, at most PREVIEW_LEVELS
+    std::unique_ptr<Chunk::Iterations_t> preview;  // Filled by Preview, then loaded into the chunk
+    std::vector<bool> previewCovered;               // Texels of preview some level covered, the others copied from the nearest of those
     Number_t texelLength;
     Number_t chunkLength;   // texelLength * Chunk::SIZE is commonly used
     Chunk_t uSize;
     Chunk_t vSize;
+    Chunk::Strategy strategy = Chunk::Strategy::BRUTE_FORCE;
+    DispatchOrder order = DispatchOrder::NEAREST_FIRST;
+    DispatchCostStats costStats;
+    Number_t averageCost = 0;   // Of whole chunks computed, for CostSource::AVERAGE
+
+    constexpr static Number_t AVERAGE_COST_WINDOW = 8;  // Chunks averageCost mostly follows
+    constexpr static Chunk_t NEIGHBOUR_REACH = 2;       // In chunks, for CostSource::NEIGHBOURS
 
-    static std::atomic<int> nowComputing;
+    Precision deepPrecision = Precision::DOUBLE_DOUBLE;    // No glitches, and about as fast as perturbation
+    Precision tierDeepPrecision = Precision::DOUBLE_DOUBLE; // Setting the tier was chosen with
+    bool floatPrecision = false;
+    bool tierFloatPrecision = false;
+    PrecisionTier tier;
+    size_t orbitMemory = DEFAULT_ORBIT_MEMORY;
+    ChunkCache cache{ DEFAULT_CACHE_MEMORY };
+    std::shared_ptr<const ReferenceOrbit> reference;   // Shared with the chunks computed against it, which share its extras
 };
 
 } // namespace mdb
@@ -0,0 +1,69 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include "common.h"
+
+namespace mdb {
+
+// Lock-free multi-producer, single-consumer queue
+// Producers push onto the head of a list with compare-and-swap; the consumer takes the whole list at once
+// and reverses it, so items come out in the order they went in, and no node is ever popped while another thread looks at it
+// One allocation per item
+template<typename T>
+class MpscQueue
+{
+public:
+
+    MpscQueue() = default;
+
+    ~MpscQueue()
+    {
+        std::vector<T> dropped;
+        Drain(dropped);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // From any thread
+    void Push(T item)
+    {
+        Node* node = new Node{ std::move(item), head.load(std::memory_order_relaxed) };
+        while (head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed) == false)
+        {
+        }
+    }
+
+    // From the consumer thread only: everything pushed so far appended to items, oldest first
+    void Drain(std::vector<T>& items)
+    {
+        Node* node = head.exchange(nullptr, std::memory_order_acquire);
+
+        const size_t begin = items.size();
+        while (node != nullptr)
+        {
+            Node* next = node->next;
+            items.push_back(std::move(node->item));
+            delete node;
+            node = next;
+        }
+        std::reverse(items.begin() + begin, items.end());
+    }
+
+private:
+
+    struct Node
+    {
+        T item;
+        Node* next;
+    };
+
+    std::atomic<Node*> head{ nullptr };
+};
+
+} // namespace mdb
+
+#endif // !MPSC_QUEUE_H
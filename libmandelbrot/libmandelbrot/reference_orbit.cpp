@@ -0,0 +1,61 @@
+#include "reference_orbit.h"
+
+namespace mdb {
+
+ReferenceOrbit::ReferenceOrbit(const Coordinate_t& x, const Coordinate_t& y, Iteration_t threshold) :
+    x(x),
+    y(y),
+    threshold(threshold)
+{
+    real.reserve(threshold + 1);
+    imag.reserve(threshold + 1);
+    glitchLimit.reserve(threshold + 1);
+
+    real.push_back(0);
+    imag.push_back(0);
+    glitchLimit.push_back(0);
+
+    Coordinate_t zr;
+    Coordinate_t zi;
+
+    for (int it = 0; it < threshold; ++it)
+    {
+        const Coordinate_t zri = zr * zi;
+        zr = zr * zr - zi * zi + x;
+        zi = zri + zri + y;
+
+        const Number_t r = zr.ToDouble();
+        const Number_t i = zi.ToDouble();
+        const Number_t magnitude = r * r + i * i;
+
+        real.push_back(r);
+        imag.push_back(i);
+        glitchLimit.push_back(magnitude * GLITCH_TOLERANCE);
+
+        if (magnitude > 2 * 2)
+        {
+            break;
+        }
+    }
+}
+
+std::vector<ReferenceOrbit::Extra> ReferenceOrbit::Extras() const
+{
+    std::lock_guard<std::mutex> lock(extrasMutex);
+    return extras;
+}
+
+ReferenceOrbit::Extra ReferenceOrbit::AddExtra(Number_t dx, Number_t dy) const
+{
+    // Outside the lock, it takes a while
+    const Extra extra = { dx, dy, std::make_shared<const ReferenceOrbit>(x + dx, y + dy, threshold) };
+
+    std::lock_guard<std::mutex> lock(extrasMutex);
+    if (static_cast<int>(extras.size()) < MAX_EXTRAS)
+    {
+        extras.push_back(extra);
+    }
+    return extra;
+}
+
+} // namespace mdb
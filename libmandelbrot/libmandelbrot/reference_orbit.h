@@ -0,0 +1,69 @@
+#ifndef REFERENCE_ORBIT_H
+#define REFERENCE_ORBIT_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "common.h"
+
+namespace mdb {
+
+// Orbit of one point, iterated at full Coordinate_t precision and stored rounded to doubles
+// Texels nearby iterate only their difference from it, which doubles hold well at any zoom
+class ReferenceOrbit
+{
+public:
+
+    // Iterates until threshold, or until the orbit escapes
+    ReferenceOrbit(const Coordinate_t& x, const Coordinate_t& y, Iteration_t threshold);
+
+    [[nodiscard]] const Coordinate_t& X() const noexcept { return x; }
+    [[nodiscard]] const Coordinate_t& Y() const noexcept { return y; }
+    [[nodiscard]] Iteration_t Threshold() const noexcept { return threshold; }
+
+    // Iterations stored: Z_0 = 0 up to Z_Length, which is outside radius 2 if the orbit escaped
+    [[nodiscard]] int Length() const noexcept { return static_cast<int>(real.size()) - 1; }
+
+    [[nodiscard]] const Number_t* Real() const noexcept { return real.data(); }
+    [[nodiscard]] const Number_t* Imag() const noexcept { return imag.data(); }
+
+    // |Z_n|^2 * GLITCH_TOLERANCE: a texel orbit closer to zero than that has lost its precision
+    [[nodiscard]] const Number_t* GlitchLimit() const noexcept { return glitchLimit.data(); }
+
+    // Pauldelbrot's criterion, squared
+    constexpr static Number_t GLITCH_TOLERANCE = 1e-6;
+
+    // Orbit of a point near this one, for texels glitched against it
+    struct Extra
+    {
+        Number_t dx;    // From this orbit's point
+        Number_t dy;
+        std::shared_ptr<const ReferenceOrbit> orbit;
+    };
+
+    // Extras are shared by every tile computed against this orbit, so each is computed once per view rather than per tile
+    // Thread-safe, so tiles computed concurrently may compute about the same one: both are kept
+    [[nodiscard]] std::vector<Extra> Extras() const;
+
+    // Computed at (dx, dy) from this orbit's point, up to its threshold, and kept for others unless MAX_EXTRAS already are
+    Extra AddExtra(Number_t dx, Number_t dy) const;
+
+    constexpr static int MAX_EXTRAS = 64;
+
+private:
+
+    Coordinate_t x;
+    Coordinate_t y;
+    Iteration_t threshold;
+
+    std::vector<Number_t> real;
+    std::vector<Number_t> imag;
+    std::vector<Number_t> glitchLimit;
+
+    mutable std::mutex extrasMutex;
+    mutable std::vector<Extra> extras;
+};
+
+} // namespace mdb
+
+#endif // !REFERENCE_ORBIT_H
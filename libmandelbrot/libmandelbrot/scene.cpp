@@ -3,8 +3,9 @@
 
 namespace mdb {
 
-Scene::Scene(RectI drawArea, Number_t texelLength) :
-    Maps{ Map(texelLength, U_SIZE, V_SIZE), Map(texelLength, U_SIZE, V_SIZE) },
+Scene::Scene(RectI drawArea, Number_t texelLength, unsigned int workerCount) :
+    pool(workerCount),
+    Maps{ Map(pool, texelLength, U_SIZE, V_SIZE), Map(pool, texelLength, U_SIZE, V_SIZE) },
     currentMap(Maps[0]), otherMap(Maps[1]),
     drawArea(drawArea)
 {
@@ -36,6 +37,7 @@ void Scene::Zoom(int zoomCenterX, int zoomCenterY, float multiplier)
 
     ZoomMovement(zoomCenterX, zoomCenterY, newPixelLength - pixelLength);
     SetNumberRange(range.x, range.y, newPixelLength);
+    SetFocus(zoomCenterX, zoomCenterY);
 }
 
 void Scene::ZoomMovement(int x, int y, Number_t dPixelLength)
@@ -49,9 +51,10 @@ void Scene::Movement(float x, float y)
     MDB_TRACE("Movement ({}, {}) {}", x, y, pixelLength);
     range.x += static_cast<Number_t>(x) * pixelLength;
     range.y -= static_cast<Number_t>(y) * pixelLength;
+    ClearFocus();
 }
 
-void Scene::SetNumberRange(Number_t originX, Number_t originY, Number_t pixelLength)
+void Scene::SetNumberRange(const Coordinate_t& originX, const Coordinate_t& originY, Number_t pixelLength)
 {           
     range = { originX, originY, drawArea.w * pixelLength, drawArea.h * pixelLength };
     this->pixelLength = pixelLength;
@@ -62,10 +65,25 @@ void Scene::Update(Iteration_t threshold)
     MDB_TRACE
     (
         "(x, y): ({}, {}) screen width: {} with pixellength {}",
-        range.x, range.y, pixelLength * drawArea.w, pixelLength
+        range.x.ToDouble(), range.y.ToDouble(), pixelLength * drawArea.w, pixelLength
     );
+    if (focused)
+    {
+        currentMap.SetFocus(range.x + static_cast<Number_t>(focusX) * pixelLength, range.y - static_cast<Number_t>(focusY) * pixelLength);
+    }
+    else
+    {
+        currentMap.ClearFocus();
+    }
+
     currentMap.UpdateBuffer(range);
     currentMap.UpdateState(texture, threshold);
+
+    // Nothing left to order
+    if (focused && currentMap.Settled())
+    {
+        ClearFocus();
+    }
 }
 
 void Scene::Draw()
@@ -5,6 +5,7 @@
 #include "common.h"
 #include "graphics.h"
 #include "map.h"
+#include "thread_pool.h"
 
 namespace mdb {
 
@@ -14,17 +15,32 @@ class Scene
 {
 public:
 
-    Scene(RectI drawArea, Number_t texelLength);
+    // workerCount of 0 uses one worker per hardware thread
+    Scene(RectI drawArea, Number_t texelLength, unsigned int workerCount = 0);
 
     // TODO: Support non-zero origin
     // TODO: support varying drawArea e.g. varying window size
 
+    // Chunks around the zoom center are computed first, until drawn, see SetFocus
     void Zoom(int zoomCenterX, int zoomCenterY, float multiplier);
 
-    // In pixels
+    // In pixels of the draw area, e.g. the mouse: chunks nearest to it are computed first
+    // Among chunks of equal predicted cost only with DispatchOrder::LONGEST_FIRST
+    // Cleared once every chunk of the view is drawn, or on Movement, the center of the draw area coming first again
+    void SetFocus(int x, int y) noexcept
+    {
+        focusX = x;
+        focusY = y;
+        focused = true;
+    }
+
+    // Back to the center of the draw area
+    void ClearFocus() noexcept { focused = false; }
+
+    // In pixels, clears the focus
     void Movement(float x, float y);
 
-    void SetNumberRange(Number_t originX, Number_t originY, Number_t pixelLength);
+    void SetNumberRange(const Coordinate_t& originX, const Coordinate_t& originY, Number_t pixelLength);
     void Update(Iteration_t threshold);
     void Draw();
     //void DebugDraw();
@@ -35,6 +51,33 @@ public:
         currentMap.Recompute();
     }
 
+    // Zoom levels a power of two apart, reusing texels across them, see Map::SetSnapping
+    void SetSnapping(bool snapping) noexcept
+    {
+        currentMap.SetSnapping(snapping);
+    }
+
+    // Float at shallow zooms, off by default, see Map::SetFloatPrecision
+    void SetFloatPrecision(bool allowed) noexcept
+    {
+        currentMap.SetFloatPrecision(allowed);
+    }
+
+    // Nearest to the focus first, or most expensive first, see DispatchOrder
+    void SetDispatchOrder(DispatchOrder order) noexcept
+    {
+        currentMap.SetDispatchOrder(order);
+    }
+
+    // Precision the view is computed in, and why
+    [[nodiscard]] const PrecisionTier& Tier() const noexcept { return currentMap.Tier(); }
+
+    // Chunks found in the cache rather than computed, see ChunkCacheStats::HitRate
+    [[nodiscard]] const ChunkCacheStats& CacheStats() const noexcept { return currentMap.CacheStats(); }
+
+    // How well chunk costs are predicted, see DispatchCostStats
+    [[nodiscard]] const DispatchCostStats& CostStats() const noexcept { return currentMap.CostStats(); }
+
 private:
 
     void ZoomMovement(int x, int y, Number_t dPixelLength);
@@ -43,13 +86,17 @@ private:
     constexpr static Chunk_t V_SIZE = 13;
 
     std::unique_ptr<Texture> texture;
-    
+
+    ThreadPool pool;    // Declared before Maps, so it outlives them
     std::array<Map, 2> Maps;
     Map& currentMap;
     Map& otherMap;
 
     NumberRange range;
     Number_t pixelLength;   // TODO: default pixelLength?
+    int focusX = 0;
+    int focusY = 0;
+    bool focused = false;
     RectI drawArea;
 };
 
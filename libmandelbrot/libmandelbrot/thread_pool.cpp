@@ -0,0 +1,166 @@
+#include "thread_pool.h"
+
+namespace mdb {
+
+// Identifies the pool and deque of the calling worker thread
+static thread_local ThreadPool* currentPool = nullptr;
+static thread_local unsigned int currentIndex = 0;
+
+ThreadPool::ThreadPool(unsigned int workerCount)
+{
+    if (workerCount == 0)
+    {
+        workerCount = DefaultWorkerCount();
+    }
+
+    MDB_INFO("Starting {} worker threads", workerCount);
+
+    localQueues.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        localQueues.push_back(std::make_unique<JobQueue>());
+    }
+
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    jobAvailable.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(Job_t job)
+{
+    unfinished.fetch_add(1);
+
+    if (currentPool == this)
+    {
+        Push(*localQueues[currentIndex], std::move(job));
+    }
+    else
+    {
+        Push(sharedQueue, std::move(job));
+    }
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(doneMutex);
+    jobsDone.wait(lock, [this] { return unfinished.load() == 0; });
+}
+
+unsigned int ThreadPool::DefaultWorkerCount() noexcept
+{
+    // May return 0 when not computable
+    unsigned int count = std::thread::hardware_concurrency();
+    return (count == 0) ? 1 : count;
+}
+
+void ThreadPool::Push(JobQueue& queue, Job_t job)
+{
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    // Taking sleepMutex orders this against a worker checking queued before it sleeps
+    queued.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    jobAvailable.notify_one();
+}
+
+bool ThreadPool::TryPop(unsigned int index, Job_t& job)
+{
+    // Own deque, newest first: the tiles of the chunk this worker just split
+    {
+        JobQueue& own = *localQueues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.jobs.empty() == false)
+        {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Steal oldest from others, starting from the next worker to spread contention
+    // Before anything new: what was submitted first finishes first
+    unsigned int count = WorkerCount();
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        JobQueue& victim = *localQueues[(index + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty() == false)
+        {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Submitted from outside, oldest first
+    {
+        std::lock_guard<std::mutex> lock(sharedQueue.mutex);
+        if (sharedQueue.jobs.empty() == false)
+        {
+            job = std::move(sharedQueue.jobs.front());
+            sharedQueue.jobs.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::WorkerLoop(unsigned int index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    for (;;)
+    {
+        Job_t job;
+
+        if (TryPop(index, job) == false)
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            jobAvailable.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+
+            // Finish queued jobs before stopping
+            if (stopping.load() && queued.load() == 0)
+            {
+                return;
+            }
+
+            continue;
+        }
+
+        job();
+
+        if (unfinished.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            jobsDone.notify_all();
+        }
+    }
+}
+
+} // namespace mdb
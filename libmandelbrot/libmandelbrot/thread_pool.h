@@ -0,0 +1,75 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include "common.h"
+
+namespace mdb {
+
+// Fixed-size set of worker threads, created once and joined on destruction
+// Each worker owns a deque: jobs submitted from a worker go to its own deque,
+// and idle workers steal from the other end of busy workers' deques before taking jobs submitted from outside
+class ThreadPool
+{
+public:
+
+    typedef std::function<void()> Job_t;
+
+    // 0 means one worker per hardware thread
+    explicit ThreadPool(unsigned int workerCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // From outside the pool: queued in submission order
+    // From a worker of this pool: pushed onto that worker's deque
+    void Submit(Job_t job);
+
+    // Blocks until every submitted job has finished
+    // Do not call from a worker
+    void Wait();
+
+    // From the deques, filled before any worker starts, unlike workers
+    [[nodiscard]] unsigned int WorkerCount() const noexcept { return static_cast<unsigned int>(localQueues.size()); }
+
+    [[nodiscard]] static unsigned int DefaultWorkerCount() noexcept;
+
+private:
+
+    // Locking deque; short critical sections, so contention stays low
+    struct JobQueue
+    {
+        std::deque<Job_t> jobs;
+        std::mutex mutex;
+    };
+
+    void WorkerLoop(unsigned int index);
+
+    [[nodiscard]] bool TryPop(unsigned int index, Job_t& job);
+    void Push(JobQueue& queue, Job_t job);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<JobQueue>> localQueues;  // One per worker
+    JobQueue sharedQueue;                               // Submitted from outside the pool
+
+    std::atomic<int> queued{ 0 };       // Jobs sitting in any queue
+    std::atomic<int> unfinished{ 0 };   // Queued plus running
+    std::atomic<bool> stopping{ false };
+
+    std::mutex sleepMutex;
+    std::condition_variable jobAvailable;
+    std::mutex doneMutex;
+    std::condition_variable jobsDone;
+};
+
+} // namespace mdb
+
+#endif // !THREAD_POOL_H
@@ -0,0 +1,33 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+// Minimal checks for the test executables, see Makefile
+// A failed check is printed and counted, the test carries on; main returns Failures() != 0
+
+#include <cstdio>
+
+namespace mdb {
+namespace test {
+
+inline int& Failures() noexcept
+{
+    static int failures = 0;
+    return failures;
+}
+
+inline bool Check(bool passed, const char* what, const char* file, int line)
+{
+    if (passed == false)
+    {
+        std::printf("FAILED %s:%d: %s\n", file, line, what);
+        ++Failures();
+    }
+    return passed;
+}
+
+} // namespace test
+} // namespace mdb
+
+#define MDB_CHECK(condition) ::mdb::test::Check((condition), #condition, __FILE__, __LINE__)
+
+#endif // !CHECK_H
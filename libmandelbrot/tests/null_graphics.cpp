@@ -0,0 +1,9 @@
+// Platform functions graphics.h asks for, doing nothing: tests draw into textures of their own
+#include "graphics.h"
+
+namespace mdb {
+
+void SetDrawAreaAsTarget() {}
+void UnsetDrawAreaAsTarget() {}
+
+} // namespace mdb
@@ -0,0 +1,47 @@
+// BigFloat::ToDouble rounds to nearest, ties to even, once from the whole mantissa
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "bigfloat.h"
+#include "check.h"
+
+using namespace mdb;
+
+namespace {
+
+BigFloat Sum(double a, double b, double c = 0)
+{
+    return BigFloat(a) + BigFloat(b) + BigFloat(c);
+}
+
+double Bit(int exponent)
+{
+    return std::ldexp(1.0, exponent);
+}
+
+} // namespace
+
+int main()
+{
+    // Doubles are exact
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> uniform(-4, 4);
+    for (int i = 0; i < 10000; ++i)
+    {
+        const double value = std::ldexp(uniform(random), static_cast<int>(random() % 200) - 100);
+        MDB_CHECK(BigFloat(value).ToDouble() == value);
+    }
+
+    // Half a unit in the last place of 1 is 2^-53
+    MDB_CHECK(Sum(1, Bit(-53)).ToDouble() == 1);                             // Tie, to even
+    MDB_CHECK(Sum(1, Bit(-52), Bit(-53)).ToDouble() == 1 + Bit(-51));        // Tie, to even
+    MDB_CHECK(Sum(1, Bit(-54), Bit(-60)).ToDouble() == 1);                   // Below half
+    MDB_CHECK(Sum(1, Bit(-53), Bit(-60)).ToDouble() == 1 + Bit(-52));        // Above half, within the top 64 bits
+    MDB_CHECK(Sum(1, Bit(-53), Bit(-200)).ToDouble() == 1 + Bit(-52));       // Above half, past the top 64 bits
+    MDB_CHECK(Sum(-1, -Bit(-53), -Bit(-200)).ToDouble() == -1 - Bit(-52));
+    MDB_CHECK((BigFloat(2) - BigFloat(Bit(-60))).ToDouble() == 2);          // Carried into the exponent
+
+    std::printf("%s\n", test::Failures() == 0 ? "BigFloat rounds to nearest" : "BigFloat rounds wrong");
+    return test::Failures() != 0;
+}
@@ -0,0 +1,286 @@
+// Every vectorized kernel the CPU supports against the scalar one, bit for bit, see Kernel
+// Lockstep and refill lanes, in float and double, over whole chunks, rows that don't split into lockstep groups,
+// lists of texels, and orbits kept then carried on; multi-double precisions over a smaller rectangle
+// Lists of texels against rectangles at the other precisions, each kernel against itself
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "kernel/kernel.h"
+#include "reference_orbit.h"
+#include "check.h"
+
+using namespace mdb;
+
+namespace {
+
+typedef KernelStats (*KernelFunction_t)(const KernelArgs&, LaneMode);
+
+constexpr int SIZE = 256;
+
+struct View
+{
+    const char* name;
+    Number_t x;             // Top-left texel
+    Number_t y;
+    Number_t texelLength;
+    Iteration_t threshold;
+};
+
+const View VIEWS[] =
+{
+    { "whole set", -2.1, 1.2, 2.4 / SIZE, 256 },
+    { "cardioid and bulb", -1.3, 0.45, 0.9 / SIZE, 1000 },
+    { "seahorse valley", -0.7453 - 128e-5, 0.1127 + 128e-5, 1e-5, 1500 },
+    { "minibrot", -1.7687, 0.0018, 2e-4 / SIZE, 2000 }
+};
+
+// Past double, for the other precisions
+const View DEEP_VIEW = { "deep seahorse", -0.7453, 0.1127, 1e-20, 400 };
+
+KernelArgs ArgsFor(const View& view, Precision precision, std::vector<Iteration_t>& iterations)
+{
+    iterations.assign(SIZE * SIZE, 0);
+
+    KernelArgs args{};
+    args.originX = view.x;
+    args.originY = view.y;
+    args.texelLength = view.texelLength;
+    args.threshold = view.threshold;
+    args.precision = precision;
+    args.beginU = 0;
+    args.beginV = 0;
+    args.width = SIZE;
+    args.height = SIZE;
+    args.iterations = iterations.data();
+    args.pitch = SIZE;
+    return args;
+}
+
+// Ways of giving texels to a kernel, each filling iterations
+struct Case
+{
+    const char* name;
+    void (*run)(KernelFunction_t compute, LaneMode mode, const View& view, Precision precision, std::vector<Iteration_t>& iterations);
+};
+
+void RunChunk(KernelFunction_t compute, LaneMode mode, const View& view, Precision precision, std::vector<Iteration_t>& iterations)
+{
+    compute(ArgsFor(view, precision, iterations), mode);
+}
+
+// Not a multiple of any lockstep group, so refill lanes either way
+void RunOddRows(KernelFunction_t compute, LaneMode mode, const View& view, Precision precision, std::vector<Iteration_t>& iterations)
+{
+    KernelArgs args = ArgsFor(view, precision, iterations);
+    args.beginU = 3;
+    args.beginV = 5;
+    args.width = 45;
+    args.height = 40;
+    compute(args, mode);
+}
+
+// Every third texel, last first
+void RunList(KernelFunction_t compute, LaneMode mode, const View& view, Precision precision, std::vector<Iteration_t>& iterations)
+{
+    std::vector<int> texels;
+    for (int texel = SIZE * SIZE - 1; texel >= 0; texel -= 3)
+    {
+        texels.push_back(texel);
+    }
+
+    KernelArgs args = ArgsFor(view, precision, iterations);
+    args.texels = &texels;
+    compute(args, mode);
+}
+
+// Orbits left at the threshold kept, then carried on to twice it
+void RunRaise(KernelFunction_t compute, LaneMode mode, const View& view, Precision precision, std::vector<Iteration_t>& iterations)
+{
+    OrbitStore store;
+    store.Reset(SIZE * SIZE * (OrbitStore::ORBIT_BYTES + OrbitStore::INSIDE_BYTES), view.threshold);
+
+    KernelArgs args = ArgsFor(view, precision, iterations);
+    args.orbits = &store;
+    compute(args, mode);
+
+    KernelArgs raise = args;
+    raise.orbits = nullptr;
+    raise.resume = &store;
+    raise.threshold = static_cast<Iteration_t>(view.threshold * 2);
+    compute(raise, mode);
+}
+
+// Orbits are taken with FLOAT and DOUBLE only, lists with any precision, see CompareLists
+const Case CASES[] =
+{
+    { "chunk", RunChunk },
+    { "odd rows", RunOddRows },
+    { "texel list", RunList },
+    { "raise", RunRaise }
+};
+
+struct Vectorized
+{
+    Kernel kernel;
+    KernelFunction_t compute;
+};
+
+const Vectorized KERNELS[] =
+{
+    { Kernel::SSE2, ComputeSSE2 },
+    { Kernel::AVX2, ComputeAVX2 },
+    { Kernel::AVX512, ComputeAVX512 }
+};
+
+int Differences(const std::vector<Iteration_t>& a, const std::vector<Iteration_t>& b)
+{
+    int count = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        count += (a[i] != b[i]) ? 1 : 0;
+    }
+    return count;
+}
+
+void Compare(const Vectorized& vectorized, LaneMode mode, const Case& with, const View& view, Precision precision)
+{
+    std::vector<Iteration_t> expected;
+    std::vector<Iteration_t> actual;
+    with.run(ComputeScalar, LaneMode::LOCKSTEP, view, precision, expected);
+    with.run(vectorized.compute, mode, view, precision, actual);
+
+    const int differences = Differences(expected, actual);
+    std::printf("%-7s %-8s %-13s %-10s %-17s %d texels differ\n", KernelName(vectorized.kernel), mode == LaneMode::LOCKSTEP ? "lockstep" : "refill",
+        PrecisionName(precision), with.name, view.name, differences);
+    MDB_CHECK(differences == 0);
+}
+
+// Lanes always in lockstep, whatever the mode
+void CompareMulti(const Vectorized& vectorized, Precision precision)
+{
+    const View& view = DEEP_VIEW;
+
+    std::vector<Iteration_t> expected;
+    std::vector<Iteration_t> actual;
+    KernelArgs args = ArgsFor(view, precision, expected);
+    args.width = 48;
+    args.height = 24;
+    ComputeScalar(args, LaneMode::LOCKSTEP);
+
+    args = ArgsFor(view, precision, actual);
+    args.width = 48;
+    args.height = 24;
+    vectorized.compute(args, LaneMode::REFILL);
+
+    const int differences = Differences(expected, actual);
+    std::printf("%-7s %-8s %-13s %-10s %-17s %d texels differ\n", KernelName(vectorized.kernel), "lockstep", PrecisionName(precision), "rectangle", view.name, differences);
+    MDB_CHECK(differences == 0);
+}
+
+// Every texel of a rectangle, last first
+std::vector<int> ListOf(const KernelArgs& args)
+{
+    std::vector<int> texels;
+    for (int v = args.beginV + args.height - 1; v >= args.beginV; --v)
+    {
+        for (int u = args.beginU + args.width - 1; u >= args.beginU; --u)
+        {
+            texels.push_back(u + v * args.pitch);
+        }
+    }
+    return texels;
+}
+
+// Lists against the rectangle, for kernels that are their own reference at a precision, over the top-left of the view
+// Texels the fixed point kernel skips or finds cyclic are those it keeps, see KeepsInside
+// With PERTURBATION, the reference orbit is that of the top-left texel
+void CompareLists(const char* name, KernelFunction_t compute, const View& view, Precision precision, int width, int height)
+{
+    std::vector<Iteration_t> expected;
+    KernelArgs args = ArgsFor(view, precision, expected);
+    args.width = width;
+    args.height = height;
+
+    // Each its own, as extra references computed for the first would be shared with the second
+    std::unique_ptr<ReferenceOrbit> reference;
+    auto fresh = [&]()
+    {
+        if (precision == Precision::PERTURBATION)
+        {
+            reference = std::make_unique<ReferenceOrbit>(view.x, view.y, view.threshold);
+            args.reference = reference.get();
+            args.originX = 0;
+            args.originY = 0;
+        }
+    };
+
+    fresh();
+    const KernelStats rectangle = compute(args, LaneMode::LOCKSTEP);
+
+    std::vector<Iteration_t> actual(SIZE * SIZE, 0);
+    const std::vector<int> texels = ListOf(args);
+    args.iterations = actual.data();
+    args.texels = &texels;
+    fresh();
+
+    OrbitStore store;
+    store.Reset(SIZE * SIZE * OrbitStore::INSIDE_BYTES, view.threshold);
+    if (KeepsInside(precision))
+    {
+        args.orbits = &store;
+    }
+
+    const KernelStats list = compute(args, LaneMode::LOCKSTEP);
+
+    const int differences = Differences(expected, actual);
+    std::printf("%-7s %-8s %-13s %-10s %-17s %d texels differ\n", name, "", PrecisionName(precision), "texel list", view.name, differences);
+    MDB_CHECK(differences == 0);
+    MDB_CHECK(list.skippedTexels == rectangle.skippedTexels && list.periodicTexels == rectangle.periodicTexels);
+    MDB_CHECK(store.Size() == 0 && store.inside.size() == (KeepsInside(precision) ? list.skippedTexels + list.periodicTexels : 0));
+}
+
+} // namespace
+
+int main()
+{
+    for (const Vectorized& vectorized : KERNELS)
+    {
+        if (KernelSupported(vectorized.kernel) == false)
+        {
+            std::printf("%-7s not supported by this CPU, skipped\n", KernelName(vectorized.kernel));
+            continue;
+        }
+
+        for (LaneMode mode : { LaneMode::LOCKSTEP, LaneMode::REFILL })
+        {
+            for (Precision precision : { Precision::FLOAT, Precision::DOUBLE })
+            {
+                for (const Case& with : CASES)
+                {
+                    for (const View& view : VIEWS)
+                    {
+                        Compare(vectorized, mode, with, view, precision);
+                    }
+                }
+            }
+        }
+
+        CompareMulti(vectorized, Precision::DOUBLE_DOUBLE);
+        CompareMulti(vectorized, Precision::QUAD_DOUBLE);
+        CompareLists(KernelName(vectorized.kernel), vectorized.compute, DEEP_VIEW, Precision::DOUBLE_DOUBLE, 48, 24);
+        CompareLists(KernelName(vectorized.kernel), vectorized.compute, DEEP_VIEW, Precision::QUAD_DOUBLE, 48, 24);
+    }
+
+    // Scalar only, so against themselves
+    CompareLists("scalar", ComputeScalar, DEEP_VIEW, Precision::DOUBLE_DOUBLE, 48, 24);
+    CompareLists("scalar", ComputeScalar, DEEP_VIEW, Precision::QUAD_DOUBLE, 48, 24);
+    CompareLists("scalar", ComputeScalar, DEEP_VIEW, Precision::PERTURBATION, SIZE, SIZE);
+    for (const View& view : VIEWS)
+    {
+        CompareLists("fixed", ComputeScalar, view, Precision::FIXED_POINT, SIZE, SIZE);
+    }
+
+    std::printf("%s\n", test::Failures() == 0 ? "All kernels match the scalar one" : "Some kernels differ from the scalar one");
+    return test::Failures() != 0;
+}
@@ -0,0 +1,250 @@
+// Map under a stream of view changes while workers compute: pans, zooms, thresholds, focus and recomputes, each racing
+// the tiles of the chunks it supersedes; once settled, what it drew must be what it draws recomputing the same view
+// Map zoomed from a settled view, so chunks take texels known from the previous level, then compared the same way
+// MpscQueue, which carries completions back from the workers, pushed to from several threads while drained
+// Meant for ThreadSanitizer too, see the tsan target of the Makefile
+//
+//   test_map_stress [frames] [seed]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+#include "map.h"
+#include "mpsc_queue.h"
+#include "thread_pool.h"
+#include "check.h"
+
+using namespace mdb;
+
+namespace {
+
+constexpr int WIDTH = 1280;             // Pixels of the view, one texel each
+constexpr int HEIGHT = 720;
+constexpr Chunk_t U_SIZE = 20;          // Chunks of the circular buffer
+constexpr Chunk_t V_SIZE = 13;
+
+// Keeps the last iteration drawn at each texel of the buffer
+class CaptureTexture : public Texture
+{
+public:
+
+    CaptureTexture() : texels(U_SIZE * Chunk::SIZE * V_SIZE * Chunk::SIZE, 0) {}
+
+    void Draw(RectI, RectF) override {}
+    void SetAsTarget() override {}
+    void UnsetAsTarget() override {}
+    void Update() override {}
+
+    void Color(int u, int v, Iteration_t iteration, Iteration_t) override
+    {
+        texels[u + v * U_SIZE * Chunk::SIZE] = iteration;
+    }
+
+    void Pending(int u, int v) override
+    {
+        texels[u + v * U_SIZE * Chunk::SIZE] = PENDING;
+    }
+
+    constexpr static Iteration_t PENDING = std::numeric_limits<Iteration_t>::max();   // Above any threshold drawn
+
+    std::vector<Iteration_t> texels;
+
+};
+
+NumberRange RangeAt(const Coordinate_t& x, const Coordinate_t& y, Number_t texelLength)
+{
+    NumberRange range;
+    range.x = x - WIDTH / 2 * texelLength;
+    range.y = y + HEIGHT / 2 * texelLength;
+    range.width = WIDTH * texelLength;
+    range.height = HEIGHT * texelLength;
+    return range;
+}
+
+// Frames until settled
+int Settle(Map& map, std::unique_ptr<Texture>& texture, const Coordinate_t& x, const Coordinate_t& y, Iteration_t threshold)
+{
+    int frames = 0;
+    do
+    {
+        map.UpdateBuffer(RangeAt(x, y, map.TexelLength()));
+        map.UpdateState(texture, threshold);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++frames;
+    } while (map.Settled() == false);
+    return frames;
+}
+
+// Starting at the given view, texel lengths only ever halved or doubled
+void StressMap(const char* name, Coordinate_t x, Coordinate_t y, Number_t texelLength, int frames, unsigned int seed)
+{
+    ThreadPool pool(4);
+    std::mt19937 random(seed);
+
+    std::unique_ptr<Texture> texture = std::make_unique<CaptureTexture>();
+    const std::vector<Iteration_t>& drawn = static_cast<CaptureTexture*>(texture.get())->texels;
+
+    Iteration_t threshold = 1500;
+
+    Map map(pool, texelLength, U_SIZE, V_SIZE);
+    map.SetSnapping(true);
+
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        const Number_t texelLength = map.TexelLength();
+        const unsigned int action = random() % 20;
+        if (action < 10)
+        {
+            x += static_cast<int>(random() % 401 - 200) * texelLength;
+            y += static_cast<int>(random() % 401 - 200) * texelLength;
+        }
+        else if (action < 14)
+        {
+            map.ChangeTexelLength((random() % 2 != 0) ? texelLength / 2 : texelLength * 2);
+        }
+        else if (action < 15)
+        {
+            map.Recompute();
+        }
+        else if (action < 17)
+        {
+            threshold = static_cast<Iteration_t>(1000 + random() % 1500);
+        }
+        else if (action < 18)
+        {
+            map.SetFocus(x, y);
+        }
+
+        map.UpdateBuffer(RangeAt(x, y, map.TexelLength()));
+        map.UpdateState(texture, threshold);
+        std::this_thread::sleep_for(std::chrono::microseconds(random() % 3000));
+    }
+
+    const int settling = Settle(map, texture, x, y, threshold);
+    const std::vector<Iteration_t> stressed = drawn;
+
+    map.Recompute();
+    Settle(map, texture, x, y, threshold);
+
+    int differences = 0;
+    for (size_t texel = 0; texel < drawn.size(); ++texel)
+    {
+        differences += (drawn[texel] != stressed[texel]) ? 1 : 0;
+    }
+
+    std::printf("%-10s %d frames, settled after %d more, %s, %d texels differ from recomputing\n", name, frames, settling,
+        PrecisionName(map.Tier().precision), differences);
+    MDB_CHECK(differences == 0);
+}
+
+// Settled at the given view, then zoomed in twice and out once, each time settled and compared to recomputing it
+// Texels of the previous level kept as known must be those computing them gives, to the bit
+void ZoomMap(const char* name, Coordinate_t x, Coordinate_t y, Number_t texelLength, Iteration_t threshold)
+{
+    ThreadPool pool(4);
+
+    std::unique_ptr<Texture> texture = std::make_unique<CaptureTexture>();
+    const std::vector<Iteration_t>& drawn = static_cast<CaptureTexture*>(texture.get())->texels;
+
+    Map map(pool, texelLength, U_SIZE, V_SIZE);
+    map.SetSnapping(true);
+    Settle(map, texture, x, y, threshold);
+
+    for (const Number_t scale : { 0.5, 0.5, 2.0 })
+    {
+        map.ChangeTexelLength(map.TexelLength() * scale);
+        Settle(map, texture, x, y, threshold);
+        const std::vector<Iteration_t> zoomed = drawn;
+
+        map.Recompute();
+        Settle(map, texture, x, y, threshold);
+
+        int differences = 0;
+        for (size_t texel = 0; texel < drawn.size(); ++texel)
+        {
+            differences += (drawn[texel] != zoomed[texel]) ? 1 : 0;
+        }
+
+        std::printf("%-10s zoomed %gx, %s, %d texels differ from recomputing\n", name, 1 / scale, PrecisionName(map.Tier().precision), differences);
+        MDB_CHECK(differences == 0);
+    }
+}
+
+// Each producer's items come out in the order it pushed them, all of them, once
+void StressQueue()
+{
+    constexpr int PRODUCERS = 4;
+    constexpr int ITEMS = 20000;    // Per producer
+
+    struct Item
+    {
+        int producer;
+        int sequence;
+    };
+
+    MpscQueue<Item> queue;
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < PRODUCERS; ++producer)
+    {
+        producers.emplace_back([&queue, producer]()
+        {
+            for (int sequence = 0; sequence < ITEMS; ++sequence)
+            {
+                queue.Push({ producer, sequence });
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    std::vector<Item> items;
+    int received = 0;
+    bool ordered = true;
+    while (received < PRODUCERS * ITEMS)
+    {
+        items.clear();
+        queue.Drain(items);
+        for (const Item& item : items)
+        {
+            ordered = ordered && item.sequence == next[item.producer];
+            next[item.producer] = item.sequence + 1;
+        }
+        received += static_cast<int>(items.size());
+        std::this_thread::yield();
+    }
+
+    for (std::thread& producer : producers)
+    {
+        producer.join();
+    }
+
+    items.clear();
+    queue.Drain(items);
+
+    std::printf("%d items from %d producers, %s\n", received, PRODUCERS, ordered ? "in order" : "out of order");
+    MDB_CHECK(ordered);
+    MDB_CHECK(received == PRODUCERS * ITEMS && items.empty());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int frames = (argc > 1) ? std::atoi(argv[1]) : 150;
+    const unsigned int seed = (argc > 2) ? static_cast<unsigned int>(std::atoi(argv[2])) : 7;
+
+    // Every lattice lays exactly over the others, and so do the doubles texels start from
+    StressMap("dyadic", std::ldexp(std::round(std::ldexp(-0.7453, 20)), -20), std::ldexp(std::round(std::ldexp(0.1127, 20)), -20),
+        std::ldexp(1.0, -17), frames, seed);
+
+    // Texels of two levels at the same point may start from doubles rounded apart, those are computed again
+    StressMap("non-dyadic", -0.7453, 0.1127, 7.3e-6, frames, seed);
+    ZoomMap("non-dyadic", -0.7453, 0.1127, 1e-5, 1500);
+    StressQueue();
+
+    return test::Failures() != 0;
+}
@@ -0,0 +1,90 @@
+// Chunk::Strategy::SUBDIVIDE_GUARDED over the default view of the demos and over a boundary-heavy one
+// The guard iterates every texel after subdividing and counts those the fill got wrong, keeping the iterated values:
+// its chunks must match brute force exactly, and subdivision must fill most texels while getting next to none wrong
+
+#include <cstdio>
+#include <memory>
+#include "chunk.h"
+#include "check.h"
+
+using namespace mdb;
+
+namespace {
+
+struct View
+{
+    const char* name;
+    Number_t x;             // Top-left texel of the top-left chunk
+    Number_t y;
+    Number_t texelLength;
+    Iteration_t threshold;
+    int chunksWide;
+    int chunksHigh;
+    double minFilled;       // Share of texels subdivision must fill
+};
+
+const View VIEWS[] =
+{
+    { "default view", -2.4, 1.075, 0.003, 256, 5, 3, 0.5 },
+    { "seahorse valley", -0.7453 - 384e-5, 0.1127 + 384e-5, 1e-5, 1500, 3, 3, 0.1 }
+};
+
+// Wrong texels, over those subdivided
+constexpr double MAX_MISMATCHES = 1e-4;
+
+void Compute(Chunk& chunk, const View& view, int cu, int cv, Chunk::Strategy strategy)
+{
+    const Coordinate_t originX = Coordinate_t(view.x) + Coordinate_t(cu * Chunk::SIZE * view.texelLength);
+    const Coordinate_t originY = Coordinate_t(view.y) - Coordinate_t(cv * Chunk::SIZE * view.texelLength);
+
+    chunk.SetPrecision(Precision::DOUBLE);
+    chunk.SetThreshold(view.threshold);
+    for (int tile = 0; tile < Chunk::TILE_COUNT; ++tile)
+    {
+        chunk.Compute(originX, originY, view.texelLength, view.threshold, Precision::DOUBLE, strategy, nullptr, tile);
+    }
+}
+
+void Run(const View& view)
+{
+    auto guarded = std::make_unique<Chunk>();
+    auto bruteForce = std::make_unique<Chunk>();
+
+    KernelStats stats;
+    int differences = 0;
+
+    for (int cv = 0; cv < view.chunksHigh; ++cv)
+    {
+        for (int cu = 0; cu < view.chunksWide; ++cu)
+        {
+            Compute(*guarded, view, cu, cv, Chunk::Strategy::SUBDIVIDE_GUARDED);
+            Compute(*bruteForce, view, cu, cv, Chunk::Strategy::BRUTE_FORCE);
+            stats += guarded->Stats();
+
+            for (int texel = 0; texel < Chunk::SIZE * Chunk::SIZE; ++texel)
+            {
+                differences += (guarded->Iterations()[texel] != bruteForce->Iterations()[texel]) ? 1 : 0;
+            }
+        }
+    }
+
+    const double texels = static_cast<double>(view.chunksWide * view.chunksHigh) * Chunk::SIZE * Chunk::SIZE;
+    std::printf("%-16s %5.1f%% of texels filled, %u filled wrong, %d differ from brute force once guarded\n",
+        view.name, 100 * stats.filledTexels / texels, stats.guardMismatches, differences);
+
+    MDB_CHECK(differences == 0);
+    MDB_CHECK(stats.filledTexels >= view.minFilled * texels);
+    MDB_CHECK(stats.guardMismatches <= MAX_MISMATCHES * texels);
+}
+
+} // namespace
+
+int main()
+{
+    for (const View& view : VIEWS)
+    {
+        Run(view);
+    }
+
+    return test::Failures() != 0;
+}